@@ -0,0 +1,198 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Offline benchmark of the signature scanner.
+ *
+ * Maps BorderlandsGOTY.exe the same way the loader would, without running it, and resolves
+ * every signature the fix uses with every scan kernel and with one and with all threads.
+ * Reports the time and throughput of every scan, and where every signature was found. Results
+ * of all kernels are compared against each other, any difference is reported and makes the
+ * benchmark exit with 1, so it doubles as a regression test for the scanner.
+ *
+ * Usage: BorderlandsGOTYEnhancedFixBench.exe [path to exe or dumped image] [runs]
+ */
+
+#include <windows.h>
+#include <iostream>
+#include <format>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstdlib>
+
+#include "utils.hpp"
+#include "signatures.hpp"
+
+namespace
+{
+    typedef struct kernel_t {
+        Utils::ScanKernel kernel;
+        const char* name;
+    } kernel_t;
+
+    constexpr kernel_t kernels[] = {
+        { Utils::ScanKernel::Scalar, "Scalar" },
+        { Utils::ScanKernel::Sse2, "Sse2" },
+        { Utils::ScanKernel::Avx2, "Avx2" },
+        { Utils::ScanKernel::Horspool, "Horspool" },
+    };
+
+    constexpr unsigned threadCounts[] = { 1, 0 };
+
+    typedef struct timing_t {
+        double min;
+        double median;
+    } timing_t;
+
+    /*
+     * Maps `path` as an image, so that sections are at their RVAs exactly like in the running
+     * game. Nothing in the image is run and no relocations are applied.
+     */
+    void* mapImage(const char* path) {
+        HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY | SEC_IMAGE, 0, 0, NULL);
+        CloseHandle(file);
+        if (!mapping) {
+            return nullptr;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        return view;
+    }
+
+    /*
+     * Bytes `patternScan` walks by default, every executable section.
+     */
+    size_t scannedBytes(void* module) {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        auto sectionHeader = IMAGE_FIRST_SECTION(ntHeaders);
+        size_t size = 0;
+        for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; i++) {
+            if (sectionHeader[i].Characteristics & IMAGE_SCN_MEM_EXECUTE) {
+                size += sectionHeader[i].Misc.VirtualSize;
+            }
+        }
+        return size;
+    }
+
+    /*
+     * Runs `scan` once to fault in the image, then `runs` more times and times each of them.
+     */
+    timing_t measure(int runs, const std::function<void()>& scan) {
+        scan();
+        std::vector<double> times;
+        for (int i = 0; i < runs; i++) {
+            auto start = std::chrono::steady_clock::now();
+            scan();
+            auto end = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return { times.front(), times[times.size() / 2] };
+    }
+
+    void report(const char* name, const char* kernel, unsigned threads, timing_t timing, size_t bytes) {
+        double throughput = (double)bytes / (timing.min / 1000.0) / 1e9;
+        std::cout << std::format("{:<16} {:<8} {:>7} {:>10.3f} {:>10.3f} {:>8.2f}\n",
+            name, kernel, threads ? std::to_string(threads) : "all", timing.min, timing.median, throughput
+        );
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : GAME_EXE;
+    int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    void* module = mapImage(path.c_str());
+    if (!module) {
+        std::cout << std::format("Failed to map {}\n", path);
+        return 1;
+    }
+    size_t bytes = scannedBytes(module);
+    std::cout << std::format("Image: {}\n", path);
+    std::cout << std::format("Scanned: {:.2f} MB, {} runs\n\n", bytes / 1e6, runs);
+    std::cout << std::format("{:<16} {:<8} {:>7} {:>10} {:>10} {:>8}\n", "Scan", "Kernel", "Threads", "Min ms", "Median ms", "GB/s");
+
+    bool mismatch = false;
+    std::vector<std::vector<uint64_t>> expected(signatures.size());
+    for (const kernel_t& kernel : kernels) {
+        Utils::setScanKernel(kernel.kernel);
+        for (unsigned threads : threadCounts) {
+            Utils::setScanThreads(threads);
+
+            for (size_t i = 0; i < signatures.size(); i++) {
+                std::vector<uint64_t> hits;
+                timing_t timing = measure(runs, [&]() {
+                    hits.clear();
+                    Utils::patternScan(module, signatures[i], &hits);
+                });
+                report(signatureNames[i], kernel.name, threads, timing, bytes);
+                if (&kernel == &kernels[0] && threads == threadCounts[0]) {
+                    expected[i] = hits;
+                }
+                else if (hits != expected[i]) {
+                    std::cout << std::format("{} found different matches with {}\n", signatureNames[i], kernel.name);
+                    mismatch = true;
+                }
+            }
+
+            std::vector<std::vector<uint64_t>> batchHits;
+            timing_t timing = measure(runs, [&]() {
+                batchHits.clear();
+                Utils::patternScan(module, signatures, &batchHits);
+            });
+            report("Batch", kernel.name, threads, timing, bytes);
+            if (batchHits != expected) {
+                std::cout << std::format("Batch found different matches with {}\n", kernel.name);
+                mismatch = true;
+            }
+
+            timing = measure(runs, [&]() {
+                batchHits.clear();
+                Utils::patternScan(module, signatures, &batchHits, 1);
+            });
+            report("Batch first", kernel.name, threads, timing, bytes);
+        }
+    }
+
+    std::cout << "\n";
+    for (size_t i = 0; i < signatures.size(); i++) {
+        std::cout << std::format("{} '{}': {} matches\n", signatureNames[i], signatures[i].string, expected[i].size());
+        for (uint64_t hit : expected[i]) {
+            std::cout << std::format("    BorderlandsGOTY.exe+{:X}\n", hit - (uint64_t)module);
+        }
+    }
+
+    UnmapViewOfFile(module);
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <optional>
+#include <cstdint>
+
+#include "utils.hpp"
+
+namespace Cache
+{
+    /**
+     * @brief Identity of a loaded executable image
+     * @details Two images with the same identity are treated as the same build of the game,
+     *      so a signature resolved on one is at the same RVA on the other.
+     */
+    typedef struct identity_t {
+        DWORD timeDateStamp;
+        DWORD sizeOfImage;
+        uint64_t textChecksum;
+    } identity_t;
+
+    /**
+     * @brief Compute the identity of a loaded module
+     * @details Takes the `TimeDateStamp` and `SizeOfImage` from the PE headers and a 64 bit
+     *      checksum over the contents of the `.text` section. The checksum is computed 8 bytes
+     *      at a time, which is far cheaper than scanning the section for signatures.
+     *
+     * @param module Base of the module
+     * @return identity_t
+     */
+    identity_t getIdentity(void* module);
+
+    /**
+     * @brief Load the signature cache for a module from disk
+     * @details Computes the identity of `module` and reads the cache file at `path`. The cached
+     *      entries are only kept if the file was written for the same identity, otherwise the
+     *      cache starts out empty and will be rewritten on the next `save`.
+     *
+     * @param module Base of the module the signatures are resolved on
+     * @param path Path to the cache file
+     * @return `true` if the cache file matched the module, `false` otherwise
+     */
+    bool load(void* module, const char* path);
+
+    /**
+     * @brief Look up the cached address of a signature
+     * @details The cached RVA is only returned after the masked bytes of `signature` were
+     *      verified at that location, so a stale entry can never result in a bad hook.
+     *
+     * @param signature Signature to look up
+     * @return Absolute address of the signature, `std::nullopt` on a cache miss
+     */
+    std::optional<uintptr_t> find(const Utils::SignatureView& signature);
+
+    /**
+     * @brief Store the resolved address of a signature in the cache
+     *
+     * @param signature Signature that was resolved
+     * @param address Absolute address where `signature` was found
+     */
+    void store(const Utils::SignatureView& signature, uintptr_t address);
+
+    /**
+     * @brief Look up a cached address that is not found through a signature
+     * @details Such as data the game writes at runtime, which can't be verified against fixed
+     *      bytes. The caller has to verify the address before using it.
+     *
+     * @param name Name the address was stored under, must not look like a signature
+     * @return Absolute address, `std::nullopt` on a cache miss
+     */
+    std::optional<uintptr_t> findAddress(const char* name);
+
+    /**
+     * @brief Store an address that is not found through a signature in the cache
+     *
+     * @param name Name to store the address under, must not look like a signature
+     * @param address Absolute address
+     */
+    void storeAddress(const char* name, uintptr_t address);
+
+    /**
+     * @brief Write the cache to disk, if anything was stored since it was loaded
+     *
+     * @param path Path to the cache file
+     * @return `true` if the cache is up to date on disk, `false` if writing failed
+     */
+    bool save(const char* path);
+}
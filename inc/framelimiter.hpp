@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+namespace FrameLimiter
+{
+    /**
+     * @brief Start limiting the game to a frame rate
+     * @details Adds a `Present` callback that holds every frame back until its deadline, one
+     *      frame period after the previous one. Most of the wait is spent blocked on a high
+     *      resolution waitable timer, only the last fraction of a millisecond is spun on QPC,
+     *      which keeps frame times tight without burning a core. A frame that is already late
+     *      is presented right away and the deadlines restart from it, so the limiter never tries
+     *      to catch up by presenting frames back to back.
+     *
+     *      On Windows versions without high resolution waitable timers a regular waitable timer
+     *      is used, with a longer spin to make up for its coarser resolution.
+     *
+     *      Must be called before `Present::install`.
+     *
+     * @param fps Frame rate to limit to, must be greater than 0
+     * @return `true` if the limiter was started, `false` if the timer or callback could not be set up
+     */
+    bool start(double fps);
+}
@@ -0,0 +1,45 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+namespace FrameTimes
+{
+    /**
+     * @brief Start capturing the time of every frame to a CSV file
+     * @details Adds a `Present` callback that takes a QPC timestamp of every frame and puts it
+     *      in a preallocated ring buffer, so the render thread never allocates, locks or touches
+     *      the disk. A background thread drains the buffer a few times a second and appends one
+     *      line per frame to `path`: the frame number, its timestamp and its frame time, both in
+     *      milliseconds, and how many frames before it were dropped because the buffer was full.
+     *      The frame time of a frame after dropped frames is left empty, as it spans the gap.
+     *
+     *      Must be called before `Present::install`.
+     *
+     * @param path Path to the CSV file, it is overwritten
+     * @return `true` if capturing was started, `false` if the file or callback could not be set up
+     */
+    bool start(const char* path);
+}
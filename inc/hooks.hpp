@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "safetyhook.hpp"
+#include "Zydis/Zydis.h"
+
+namespace Hooks
+{
+    /**
+     * @brief Instruction to place a hook on, described by what it does
+     * @details Found by decoding forward from the address a signature was found at, see
+     *      `resolveSite`, so the hook does not depend on the exact offset of the instruction
+     *      within the signature. Fields left at their default match anything.
+     */
+    typedef struct Site {
+        ZydisMnemonic mnemonic;                         // Mnemonic of the instruction
+        ZydisRegister source = ZYDIS_REGISTER_NONE;     // Register read by its second operand
+        ZydisMnemonic after = ZYDIS_MNEMONIC_INVALID;   // Mnemonic of an instruction it has to follow
+    } Site;
+
+    /**
+     * @brief Find the instruction described by `site` after `anchor`
+     * @details Decodes instruction by instruction from `anchor`, at most 64 bytes, and returns
+     *      the first instruction matching `site`. The site is only returned if a hook can be
+     *      placed there safely, which takes overwriting the 5 bytes from its start with a jmp:
+     *      - Every instruction covering the 5 bytes has to decode.
+     *      - No branch decoded on the way from `anchor` may land within the 5 bytes after the
+     *        start of the site, it would land in the middle of the jmp.
+     *
+     *      Bytes after a ret or jmp within the 5 bytes should be int3 or nop padding, anything
+     *      else could be the start of another function. Such a site is still returned, as it
+     *      always was hooked, but `problem` says so, so that the caller can warn about it.
+     *
+     * @param anchor Address a signature was found at
+     * @param site Instruction to find
+     * @param problem Optional, receives why the site was rejected, or what is risky about the
+     *      returned site, `nullptr` if nothing is
+     * @return Address of the instruction, `nullptr` if it was not found or is not safe to hook
+     */
+    void* resolveSite(void* anchor, const Site& site, const char** problem = nullptr);
+
+    /**
+     * @brief Installs mid hooks and direct patches together
+     * @details A batch creates every hook disabled when it is added, which prepares the
+     *      trampoline and everything else that needs allocating before any hook goes live, and
+     *      prepares the bytes and code cave of every direct patch. `commit` then enables the
+     *      pending hooks one after another, each in the freeze safetyhook runs for it, and
+     *      applies all pending direct patches in a single freeze of its own.
+     *
+     *      Enabling a hook allocates and takes locks, so it must never run while the game's
+     *      threads are frozen: a frozen thread may be holding the process heap or the loader
+     *      lock. Inside the batch's freeze only the patch bytes are copied and the threads
+     *      stopped on them are moved, nothing is logged, allocated or locked.
+     *
+     *      The batch owns its hooks, they are removed when it is destroyed. Direct patches
+     *      added with `addMovEax` are permanent.
+     *
+     * @code
+     * Hooks::Batch hooks;
+     * hooks.add(target0, [](SafetyHookContext& ctx) { ... });
+     * hooks.add(target1, [](SafetyHookContext& ctx) { ... });
+     * hooks.commit();
+     * @endcode
+     */
+    class Batch {
+    public:
+        /**
+         * @brief Create a disabled mid hook to be enabled on the next `commit`
+         *
+         * @param target Address to hook
+         * @param destination Function to call when `target` is reached
+         * @return `true` if the hook was created, `false` if safetyhook could not hook `target`
+         */
+        bool add(void* target, safetyhook::MidHookFn destination);
+
+        /**
+         * @brief Patch code to set eax to a constant, to be applied on the next `commit`
+         * @details Does the same as a mid hook at `target` that only sets `ctx.rax = value`,
+         *      without saving and restoring the whole context every time `target` runs. The
+         *      instructions at `target` are decoded with Zydis and patched in one of two ways:
+         *      - `target` is a ret followed by at least 5 bytes of int3 padding: the ret and the
+         *        padding are overwritten in place with `mov eax, value; ret`.
+         *      - Otherwise the instructions covering the first 5 bytes are moved to a code cave
+         *        allocated within 2GB of `target`, after a `mov eax, value` and followed by a jmp
+         *        back, and `target` jumps to the cave. RIP relative memory operands are
+         *        relocated. Instructions that branch, call or return can not be moved.
+         *      A thread that is stopped on the moved instructions when the patch is applied is
+         *      moved to the same instruction in the cave.
+         *
+         * @param target Address of the instruction to set eax before
+         * @param value Value to set eax to, this zero extends into rax like `ctx.rax = value`
+         * @return `true` if the patch was prepared, `false` if the code at `target` can not be
+         *      patched directly, a mid hook has to be used instead
+         */
+        bool addMovEax(void* target, uint32_t value);
+
+        /**
+         * @brief Enable every hook and apply every patch added since the last commit, the patches
+         *      with one thread freeze
+         *
+         * @return Number of hooks that were enabled and patches that were applied
+         */
+        size_t commit();
+
+        /**
+         * @brief Number of hooks and patches added since the last commit
+         *
+         * @return size_t
+         */
+        size_t pending() const;
+
+    private:
+        typedef struct patch_t {
+            uint8_t* target;
+            std::vector<uint8_t> bytes;
+            uint8_t* cave;
+            size_t displaced;
+        } patch_t;
+
+        std::vector<SafetyHookMid> hooks;
+        std::vector<patch_t> patches;
+        std::vector<safetyhook::Allocation> caves;
+        size_t committed = 0;
+        size_t committedPatches = 0;
+    };
+}
@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <dxgi.h>
+#include <cstddef>
+
+namespace Present
+{
+    /**
+     * @brief Function called every time the game presents a frame
+     * @details Called on the game's render thread right before the frame is presented, it
+     *      must be cheap as it adds directly to the frame time.
+     *
+     * @param swapChain Swap chain the frame is presented on
+     * @param context Pointer passed to `addCallback`
+     */
+    typedef void (*PresentCallback)(IDXGISwapChain* swapChain, void* context);
+
+    /**
+     * @brief Maximum number of callbacks that can be added
+     */
+    constexpr size_t maxCallbacks = 8;
+
+    /**
+     * @brief Whether Present is hooked, set by `install`
+     */
+    extern bool installed;
+
+    /**
+     * @brief Add a function to be called every time the game presents a frame
+     * @details Callbacks are called in the order they were added. They can only be added
+     *      before `install`, so the render thread never sees the list change.
+     *
+     * @param callback Function to call
+     * @param context Passed to `callback` as is
+     * @return `true` if the callback was added, `false` if there are too many callbacks or the
+     *      hook is already installed
+     */
+    bool addCallback(PresentCallback callback, void* context = nullptr);
+
+    /**
+     * @brief Hook IDXGISwapChain::Present to call the added callbacks
+     * @details The address of Present is taken from the vtable of a swap chain created on a
+     *      hidden window just for this, which is released right after. Present is implemented
+     *      by dxgi.dll, so the game's swap chains share the hooked function. Does nothing if
+     *      no callbacks were added.
+     *
+     * @return `true` if the hook is installed or there was nothing to install, `false` if
+     *      Present could not be found or hooked
+     */
+    bool install();
+}
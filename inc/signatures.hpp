@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "utils.hpp"
+
+/*
+ * Every signature used by the fixes and features. They are all resolved together by
+ * `scanSignatures()` in main.cpp so that the game's module only has to be walked once, no
+ * matter how many fixes there are. They live here so the scan benchmark uses the same ones.
+ * The signatures are compiled at build time, a malformed signature will fail to compile.
+ */
+enum signature_t {
+    ResWidth,
+    ResHeight,
+    ResAspectClamp,
+    MasterFov,
+    SprintFov,
+    SignatureCount
+};
+inline const std::vector<Utils::SignatureView> signatures = {
+    Utils::signature<"44 8B ?? 41 8D ?? ?? 48 8B ?? ?? ?? FF 15 ?? ?? ?? ??">,                          // ResWidth
+    Utils::signature<"FF 15 ?? ?? ?? ?? 44 8B ?? 45 8B ??">,                                            // ResHeight
+    Utils::signature<"CC    8B 81 A0 00 00 00    C3    CC">,                                            // ResAspectClamp
+    Utils::signature<"F3 0F 11 ?? ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? 89 ?? ?? ?? ?? ?? 48 83 ?? ?? 5B C3">,  // MasterFov
+    Utils::signature<"F3 0F 10 80 3C 07 00 00    C3    CC">,                                            // SprintFov
+};
+
+/*
+ * Name of every signature, used when logging about them. Every hook is installed at one of
+ * the signatures, so the hooks are instrumented under these names too, see `Stats::init()`.
+ */
+inline const char* const signatureNames[SignatureCount] = {
+    "ResWidth",
+    "ResHeight",
+    "ResAspectClamp",
+    "MasterFov",
+    "SprintFov",
+};
@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <span>
+#include <cstdint>
+#include <intrin.h>
+
+#include "telemetry.hpp"
+
+namespace Stats
+{
+    /**
+     * @brief Maximum number of hooks that can be instrumented
+     */
+    constexpr size_t maxHooks = 8;
+
+    /**
+     * @brief Whether calls are currently being recorded, set by `init`
+     */
+    extern bool enabled;
+
+    /**
+     * @brief Start recording calls to the hooks
+     * @details Every hook is identified by its index into `names`, which is also the name it is
+     *      logged under. A background thread logs a summary of every hook every `interval`
+     *      seconds, a summary can also be logged at any time with `logSummary`.
+     *      Until this is called `Scope` records nothing.
+     *
+     * @param names Name of every hook, at most `maxHooks`, must outlive the program
+     * @param interval Seconds between summaries, must be greater than 0
+     */
+    void init(std::span<const char* const> names, unsigned interval);
+
+    /**
+     * @brief Record one call to a hook that took `cycles` TSC cycles
+     * @details Each thread records into its own cache line aligned slot, so hooks running on
+     *      different threads never contend on the same cache line. Latencies are kept in a
+     *      histogram of power of two buckets.
+     *
+     * @param hook Index of the hook as passed to `init`
+     * @param cycles Duration of the call in TSC cycles
+     */
+    void record(size_t hook, uint64_t cycles);
+
+    /**
+     * @brief Log the number of calls and the latency distribution of every hook
+     * @details Percentiles are the upper bound of the power of two bucket they fall in, so
+     *      they are accurate to within a factor of 2.
+     */
+    void logSummary();
+
+    /**
+     * @brief Records the duration of the scope it lives in as a call to a hook
+     * @details Meant to be the first statement in the body of a hook. It only measures the body,
+     *      the cost of getting into and out of the hook is not included. The call is recorded
+     *      for the summaries if `enabled`, and in the shared telemetry if `Telemetry::enabled`.
+     *
+     * @code
+     * [](SafetyHookContext& ctx) {
+     *     Stats::Scope scope(MasterFov);
+     *     ...
+     * }
+     * @endcode
+     */
+    class Scope {
+    public:
+        explicit Scope(size_t hook) : hook(hook), start(enabled || Telemetry::enabled ? __rdtsc() : 0) {}
+        ~Scope() {
+            if (start) {
+                uint64_t cycles = __rdtsc() - start;
+                if (enabled) {
+                    record(hook, cycles);
+                }
+                if (Telemetry::enabled) {
+                    Telemetry::recordHook(hook, cycles);
+                }
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        size_t hook;
+        uint64_t start;
+    };
+}
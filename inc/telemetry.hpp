@@ -0,0 +1,127 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <span>
+#include <atomic>
+#include <cstdint>
+
+namespace Telemetry
+{
+    /**
+     * @brief Name of the file mapping the telemetry is published in
+     * @details Other processes of the same user open it with
+     *      `OpenFileMappingA(FILE_MAP_READ, FALSE, mappingName)` and map it read-only.
+     */
+    constexpr const char* mappingName = "Local\\BorderlandsGOTYEnhancedFix.Telemetry";
+
+    constexpr uint32_t magic = 0x54594742; // "BGYT"
+    constexpr uint32_t version = 2;
+
+    /**
+     * @brief Maximum number of hooks in the telemetry, same as `Stats::maxHooks`
+     */
+    constexpr size_t maxHooks = 8;
+
+    /**
+     * @brief Bucket `i` of a histogram counts samples below 2^i, the last one everything above
+     */
+    constexpr size_t bucketCount = 32;
+
+    /**
+     * @brief Counters of one hook, latencies are in TSC cycles
+     */
+    typedef struct alignas(64) hook_telemetry_t {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> cycles;
+        std::atomic<uint64_t> buckets[bucketCount];
+    } hook_telemetry_t;
+
+    /**
+     * @brief Counters of the frames presented, frame times are in microseconds
+     */
+    typedef struct alignas(64) frame_telemetry_t {
+        std::atomic<uint64_t> frames;
+        std::atomic<int64_t> lastPresent;     // QPC timestamp of the last frame
+        std::atomic<uint64_t> lastFrameTime;  // Frame time of the last frame
+        std::atomic<uint64_t> buckets[bucketCount];
+    } frame_telemetry_t;
+
+    /**
+     * @brief Layout of the file mapping
+     * @details Everything above `frame` is written once before `magic` is stored, a reader
+     *      that sees `magic` and `version` can rely on the rest of the header. When a game
+     *      starts while the mapping still exists, because a reader holds it open from an
+     *      earlier session or another instance publishes to it, `magic` is cleared,
+     *      `generation` is incremented and every counter is reset before `magic` is stored
+     *      again. A reader that sees `generation` change starts over. The counters are
+     *      updated in place with relaxed atomic adds and stores, each one is consistent on its
+     *      own but two of them may be read one update apart. A reader can map it with the same
+     *      struct made of plain integers, the frame and hook counters start on 64-byte lines.
+     */
+    typedef struct telemetry_t {
+        std::atomic<uint32_t> magic;
+        std::atomic<uint32_t> generation;     // Incremented every time a game (re)initializes the mapping
+        uint32_t version;
+        uint32_t size;                        // sizeof(telemetry_t)
+        uint32_t processId;                   // Game publishing to the mapping
+        int64_t qpcFrequency;                 // QPC ticks per second, for `lastPresent`
+        uint32_t hookCount;
+        char hookNames[maxHooks][32];
+        frame_telemetry_t frame;
+        hook_telemetry_t hooks[maxHooks];
+    } telemetry_t;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "counters are shared with other processes");
+
+    /**
+     * @brief Whether the telemetry is published, set by `start`
+     */
+    extern bool enabled;
+
+    /**
+     * @brief Create the file mapping and start publishing to it
+     * @details Adds a `Present` callback that counts every frame, so it must be called before
+     *      `Present::install`. The mapping stays for as long as the game runs. Until this is
+     *      called `recordHook` is never reached. A mapping left behind by an earlier session or
+     *      another instance of the game is taken over and reset, see `telemetry_t`. Every
+     *      reason the telemetry could not be started is logged as a warning.
+     *
+     * @param names Name of every hook, only the first `maxHooks` are published
+     * @return `true` if the telemetry is published, `false` if the mapping or callback could
+     *      not be set up
+     */
+    bool start(std::span<const char* const> names);
+
+    /**
+     * @brief Record one call to a hook that took `cycles` TSC cycles
+     * @details Wait-free, a few atomic adds straight into the mapping.
+     *
+     * @param hook Index of the hook as passed to `start`
+     * @param cycles Duration of the call in TSC cycles
+     */
+    void recordHook(size_t hook, uint64_t cycles);
+}
@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+
+#include "trace.hpp"
+
+namespace Timing
+{
+    /**
+     * @brief Maximum number of distinct startup phases that can be timed
+     */
+    constexpr size_t maxPhases = 16;
+
+    /**
+     * @brief Mark the moment startup begins, everything is timed relative to it
+     * @details Meant to be called from `DLL_PROCESS_ATTACH`, before the thread applying the
+     *      fixes is created.
+     */
+    void start();
+
+    /**
+     * @brief Mark the moment startup is done
+     * @details Fixes the total reported by `logSummary` and `writeJson`, until this is called
+     *      they report the time up to the moment they are called.
+     */
+    void stop();
+
+    /**
+     * @brief Add `ticks` QPC ticks to the phase called `name`
+     * @details Phases that are entered more than once, such as one per hook, are summed up and
+     *      their count is reported along with the total. Phases are kept in the order they
+     *      were first recorded, once `maxPhases` exist new names are ignored. Not thread safe,
+     *      phases are only recorded by the thread applying the fixes.
+     *
+     * @param name Name of the phase, must outlive the program
+     * @param ticks Duration in QPC ticks
+     */
+    void record(const char* name, int64_t ticks);
+
+    /**
+     * @brief Log the total startup time and every phase on a single line
+     * @details The line is made up of `name=milliseconds` pairs, a phase entered more than once
+     *      is followed by `xcount`, so it can be picked apart by a script.
+     */
+    void logSummary();
+
+    /**
+     * @brief Write the total startup time and every phase to a JSON file
+     *
+     * @param path Path of the file, it is overwritten
+     * @return `true` if the file was written
+     */
+    bool writeJson(const char* path);
+
+    /**
+     * @brief Records the duration of the scope it lives in as a phase
+     * @details Also emits the start and stop events of the phase, see `Trace::phaseStart()`.
+     *
+     * @code
+     * {
+     *     Timing::Phase phase("readYml");
+     *     readYml();
+     * }
+     * @endcode
+     */
+    class Phase {
+    public:
+        explicit Phase(const char* name) : name(name) {
+            Trace::phaseStart(name);
+            QueryPerformanceCounter(&begin);
+        }
+        ~Phase() {
+            LARGE_INTEGER end;
+            QueryPerformanceCounter(&end);
+            record(name, end.QuadPart - begin.QuadPart);
+            Trace::phaseStop(name, end.QuadPart - begin.QuadPart);
+        }
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+    private:
+        const char* name;
+        LARGE_INTEGER begin;
+    };
+}
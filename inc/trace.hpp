@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+#include <cstdint>
+#include <intrin.h>
+
+/*
+ * ETW provider "BorderlandsGOTYEnhancedFix", the GUID is derived from the name so sessions can
+ * enable it as *BorderlandsGOTYEnhancedFix.
+ */
+TRACELOGGING_DECLARE_PROVIDER(traceProvider);
+
+namespace Trace
+{
+    /**
+     * @brief Keywords to enable the events of the provider with
+     */
+    constexpr ULONGLONG keywordPhase = 0x1;  // Start and stop of every startup phase
+    constexpr ULONGLONG keywordHook = 0x2;   // Sampled calls to the hooks
+
+    /**
+     * @brief Only every that many calls to a hook on a thread emit an event
+     */
+    constexpr uint32_t hookSampleRate = 64;
+
+    /**
+     * @brief Register the provider
+     * @details Meant to be called from `DLL_PROCESS_ATTACH`, until then no events are emitted.
+     */
+    void init();
+
+    /**
+     * @brief Unregister the provider
+     * @details Has to be called from `DLL_PROCESS_DETACH` at the latest.
+     */
+    void shutdown();
+
+    /**
+     * @brief Emit the start and stop event of a startup phase
+     *
+     * @param name Name of the phase
+     * @param ticks Duration of the phase in QPC ticks, on the stop event
+     */
+    void phaseStart(const char* name);
+    void phaseStop(const char* name, int64_t ticks);
+
+    /**
+     * @brief Emit one call to a hook
+     *
+     * @param hook Index of the hook, the `signature_t` it was found with
+     * @param input Value the hook read, the FOV for the FOV hooks
+     * @param output Value the hook wrote back
+     * @param cycles Duration of the call in TSC cycles
+     */
+    void hook(size_t hook, float input, float output, uint64_t cycles);
+
+    /**
+     * @brief Whether a session is listening for hook events
+     * @details Only reads a flag of the provider, which ETW updates when sessions come and go.
+     */
+    inline bool hookEnabled() {
+        return TraceLoggingProviderEnabled(traceProvider, WINEVENT_LEVEL_VERBOSE, keywordHook);
+    }
+
+    /**
+     * @brief Emits a sampled event for the call to the hook it lives in
+     * @details Placed right after `Stats::Scope` at the start of a hook. When no session is
+     *      listening this costs a flag check, otherwise every `hookSampleRate`th call on a
+     *      thread is timed and emitted.
+     *
+     * @code
+     * [](SafetyHookContext& ctx) {
+     *     Stats::Scope scope(MasterFov);
+     *     Trace::HookScope trace(MasterFov, ctx.xmm0.f32[0]);
+     *     ...
+     *     trace.setOutput(ctx.xmm0.f32[0]);
+     * }
+     * @endcode
+     */
+    class HookScope {
+    public:
+        HookScope(size_t hook, float input) : hook(hook), input(input), output(input), start(0) {
+            if (hookEnabled() && ++calls % hookSampleRate == 0) {
+                start = __rdtsc();
+            }
+        }
+        ~HookScope() {
+            if (start) {
+                Trace::hook(hook, input, output, __rdtsc() - start);
+            }
+        }
+        void setOutput(float value) {
+            output = value;
+        }
+        HookScope(const HookScope&) = delete;
+        HookScope& operator=(const HookScope&) = delete;
+
+    private:
+        size_t hook;
+        float input;
+        float output;
+        uint64_t start;
+        static inline thread_local uint32_t calls = 0;
+    };
+}
@@ -27,9 +27,191 @@
 #include <windows.h>
 #include <vector>
 #include <string>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <type_traits>
 
 namespace Utils
 {
+    /**
+     * @brief Callback invoked by `patternScan` for every match
+     *
+     * @param address Address where the pattern was found
+     * @param context User provided pointer passed through `patternScan`
+     * @return `true` to keep scanning, `false` to stop the scan
+     */
+    typedef bool (*ScanCallback)(uint64_t address, void* context);
+
+    /**
+     * @brief Type erased view of a signature compiled at build time
+     * @details Refers to the byte and mask arrays of a `Signature`, which is what the scanner
+     *      works with. A mask byte of 0xFF means the byte has to match, 0x00 is a wildcard.
+     *      `matches` compares all `size` bytes and is instantiated for the exact pattern
+     *      length, so the compare loop has a trip count known at compile time.
+     */
+    typedef struct SignatureView {
+        const uint8_t* bytes;
+        const uint8_t* mask;
+        size_t size;
+        size_t anchor0; // Offset of the rarest non-wildcard byte, `SIZE_MAX` if there is none
+        size_t anchor1; // Offset of the second rarest non-wildcard byte
+        const char* string;
+        bool (*matches)(const uint8_t* scanBytes, const SignatureView& signature);
+    } SignatureView;
+
+    namespace detail
+    {
+        template <size_t N>
+        struct StringLiteral {
+            consteval StringLiteral(const char (&string)[N]) {
+                for (size_t i = 0; i < N; i++) {
+                    value[i] = string[i];
+                }
+            }
+            char value[N];
+        };
+
+        /*
+         * Bytes that show up the most in x86-64 code, most common first. Anything not listed is
+         * considered rare. Patterns are anchored on their rarest bytes so that as few positions
+         * as possible have to go through a full compare.
+         */
+        constexpr uint8_t commonBytes[] = {
+            0x00, 0xFF, 0x48, 0x8B, 0xCC, 0x89, 0x24, 0x0F, 0x4C, 0x44, 0x85, 0xE8,
+            0x83, 0x01, 0xC0, 0x08, 0x10, 0x8D, 0x20, 0xC3, 0x41, 0x74, 0x49, 0x45,
+        };
+
+        constexpr size_t byteRank(int byte) {
+            for (size_t i = 0; i < std::size(commonBytes); i++) {
+                if (commonBytes[i] == byte) {
+                    return std::size(commonBytes) - i;
+                }
+            }
+            return 0;
+        }
+
+        consteval int hexDigit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            throw "Signature contains a character that is not a hex digit, wildcard or space";
+        }
+
+        /*
+         * Walks the IDA-style signature and returns the number of bytes in it. When `bytes` and
+         * `mask` are given they are filled in as well. Every token has to be a two digit hex
+         * byte, `?` or `??`, separated by any number of spaces, anything else fails to compile.
+         */
+        consteval size_t parseSignature(const char* string, uint8_t* bytes = nullptr, uint8_t* mask = nullptr) {
+            size_t size = 0;
+            for (const char* current = string; *current; ) {
+                if (*current == ' ') {
+                    current++;
+                    continue;
+                }
+                if (*current == '?') {
+                    current += current[1] == '?' ? 2 : 1;
+                    if (bytes) {
+                        bytes[size] = 0x00;
+                        mask[size] = 0x00;
+                    }
+                }
+                else {
+                    int value = hexDigit(current[0]) << 4;
+                    value |= hexDigit(current[1]);
+                    current += 2;
+                    if (bytes) {
+                        bytes[size] = (uint8_t)value;
+                        mask[size] = 0xFF;
+                    }
+                }
+                if (*current != ' ' && *current != '\0') {
+                    throw "Signature tokens must be separated by spaces";
+                }
+                size++;
+            }
+            if (size == 0) {
+                throw "Signature is empty";
+            }
+            return size;
+        }
+
+        template <size_t N>
+        bool signatureMatches(const uint8_t* scanBytes, const SignatureView& signature) {
+            for (size_t i = 0; i < N; i++) {
+                if ((scanBytes[i] ^ signature.bytes[i]) & signature.mask[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief Signature compiled from an IDA-style byte array pattern at build time
+     * @details Holds the pattern as fixed-size byte and mask arrays, along with the anchor
+     *      bytes the scanner searches for, so nothing has to be parsed when the fix starts.
+     *      Created through the `signature` variable template, a malformed pattern fails to
+     *      compile. Converts to a `SignatureView` for use with `patternScan`.
+     */
+    template <size_t N>
+    struct Signature {
+        uint8_t bytes[N];
+        uint8_t mask[N];
+        size_t anchor0;
+        size_t anchor1;
+        const char* string;
+
+        static constexpr size_t size = N;
+
+        constexpr operator SignatureView() const {
+            return { bytes, mask, N, anchor0, anchor1, string, &detail::signatureMatches<N> };
+        }
+    };
+
+    namespace detail
+    {
+        template <StringLiteral S>
+        consteval auto compileSignature() {
+            constexpr size_t size = parseSignature(S.value);
+            Signature<size> signature = {};
+            parseSignature(S.value, signature.bytes, signature.mask);
+            signature.anchor0 = SIZE_MAX;
+            signature.anchor1 = SIZE_MAX;
+            for (size_t i = 0; i < size; i++) {
+                if (!signature.mask[i]) {
+                    continue;
+                }
+                if (signature.anchor0 == SIZE_MAX || byteRank(signature.bytes[i]) < byteRank(signature.bytes[signature.anchor0])) {
+                    signature.anchor1 = signature.anchor0;
+                    signature.anchor0 = i;
+                }
+                else if (signature.anchor1 == SIZE_MAX || byteRank(signature.bytes[i]) < byteRank(signature.bytes[signature.anchor1])) {
+                    signature.anchor1 = i;
+                }
+            }
+            if (signature.anchor1 == SIZE_MAX) {
+                signature.anchor1 = signature.anchor0;
+            }
+            signature.string = S.value;
+            return signature;
+        }
+    }
+
+    /**
+     * @brief Signature compiled at build time from an IDA-style byte array pattern
+     *
+     * @code
+     * constexpr auto& ret = Utils::signature<"C3 CC ?? CC">;
+     * auto hit = Utils::patternScanFirst(module, ret);
+     * @endcode
+     */
+    template <detail::StringLiteral S>
+    inline constexpr auto signature = detail::compileSignature<S>();
+
     /**
      * @brief Retrieves information about the compiler being used.
      * @details This function returns a string containing the name and version of the
@@ -90,6 +272,195 @@ namespace Utils
      */
     void patch(uintptr_t address, const char* pattern);
 
+    /**
+     * @brief Patch an area of memory with raw bytes
+     * @details Same as `patch(uintptr_t, const char*)` but takes the bytes as they are, so
+     *      there is no need to format them as a hex string first.
+     *
+     * @param address Starting memory address
+     * @param bytes Bytes to write starting at `address`
+     */
+    void patch(uintptr_t address, std::span<const uint8_t> bytes);
+
+    /**
+     * @brief Patch an area of memory with the bytes of a value
+     * @details Writes the object representation of `value` to `address`, `sizeof(T)` bytes
+     *      are patched. Pointers and arrays are not accepted, pass a `std::span` to patch
+     *      with the bytes they point to.
+     *
+     * @param address Starting memory address
+     * @param value Value to write
+     *
+     * @code
+     * patch(address, 1920); // Same as patch(address, "80 07 00 00")
+     * @endcode
+     */
+    template<typename T>
+        requires std::is_trivially_copyable_v<T> && (!std::is_pointer_v<T>) && (!std::is_array_v<T>)
+    void patch(uintptr_t address, const T& value) {
+        patch(address, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(&value), sizeof(T)));
+    }
+
+    /**
+     * @brief Collects patches and applies them with as few protection changes as possible
+     * @details `patch` changes the protection of the patched memory twice for every call.
+     *      A batch instead remembers every patch that is added and applies all of them in
+     *      `commit`, where patches on the same or neighbouring pages share one protection change
+     *      per range of pages. Ranges are split where the original protection of the pages
+     *      differs, so every page gets its own protection back.
+     *
+     *      Patches are applied in the order they were added for any bytes that overlap.
+     *
+     * @code
+     * Utils::PatchBatch batch;
+     * batch.add(address0, 1920);
+     * batch.add(address1, 1080);
+     * batch.commit();
+     * @endcode
+     */
+    class PatchBatch {
+    public:
+        /**
+         * @brief Add raw bytes to be written to `address` on `commit`
+         *
+         * @param address Starting memory address
+         * @param bytes Bytes to write, they are copied so they need not outlive the call
+         */
+        void add(uintptr_t address, std::span<const uint8_t> bytes);
+
+        /**
+         * @brief Add the bytes of a value to be written to `address` on `commit`
+         *
+         * @param address Starting memory address
+         * @param value Value to write
+         */
+        template<typename T>
+            requires std::is_trivially_copyable_v<T> && (!std::is_pointer_v<T>) && (!std::is_array_v<T>)
+        void add(uintptr_t address, const T& value) {
+            add(address, std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(&value), sizeof(T)));
+        }
+
+        /**
+         * @brief Apply all added patches and clear the batch
+         *
+         * @return Number of protection changes that were needed
+         */
+        size_t commit();
+
+    private:
+        typedef struct entry_t {
+            uintptr_t address;
+            size_t offset;
+            size_t size;
+        } entry_t;
+
+        std::vector<entry_t> entries;
+        std::vector<uint8_t> data;
+    };
+
+    /**
+     * @brief Check passed to `waitForWrite` to tell if the range holds what was waited for
+     *
+     * @param address Start of the watched range
+     * @return `true` if the range holds the expected values
+     */
+    typedef bool (*WriteCheck)(uintptr_t address);
+
+    /**
+     * @brief Interval `waitForWrite` calls its `ready` check at, in milliseconds
+     */
+    constexpr DWORD writePollInterval = 10;
+
+    /**
+     * @brief Wait until the game writes to a range of memory
+     * @details Calls `ready` every `writePollInterval` milliseconds until it returns `true`.
+     *      After that the range is polled until it has not changed for `settle` milliseconds,
+     *      so that a value written in several steps is complete by the time this returns.
+     *      Neither wait goes past `timeout`, counted from the call.
+     *
+     *      The range is only ever read, the game's accesses to it are left alone. `ready` and
+     *      the settle check read it from the waiting thread, so it must stay readable.
+     *
+     * @param address Start of the range to watch
+     * @param size Size of the range in bytes
+     * @param ready Check of the range, the range counts as written once it returns `true`
+     * @param timeout Maximum time to wait, in milliseconds
+     * @param settle Time without changes after which the range is considered written, in milliseconds
+     * @return `true` if `ready` returned `true`, `false` if `timeout` elapsed first
+     */
+    bool waitForWrite(uintptr_t address, size_t size, WriteCheck ready, DWORD timeout, DWORD settle = 250);
+
+    /**
+     * @brief Kernels `patternScan` can search with
+     */
+    enum class ScanKernel {
+        Auto,     // Fastest SIMD kernel the CPU supports
+        Scalar,   // One byte at a time
+        Sse2,     // 16 bytes at a time
+        Avx2,     // 32 bytes at a time, falls back to Sse2 if the CPU lacks AVX2
+#ifdef ENABLE_BENCH_KERNELS
+        Horspool, // Skips ahead on the longest fixed run, single patterns only, benchmark builds only
+#endif
+    };
+
+    /**
+     * @brief Force the kernel `patternScan` searches with
+     * @details Every kernel finds the same matches in the same order, this only exists to
+     *      compare their speed. The default is `ScanKernel::Auto`.
+     *
+     * @param kernel Kernel to search with
+     */
+    void setScanKernel(ScanKernel kernel);
+
+    /**
+     * @brief Set the number of threads `patternScan` may use
+     * @details The scan ranges are split into chunks which are handed out to a pool of up to
+     *      `threads` threads, the calling thread included, for the duration of each scan.
+     *      Chunks are split on pattern start offsets, so the last offsets of a chunk read up to
+     *      pattern length - 1 bytes into the next one and no match is lost at a chunk boundary.
+     *      The results are merged in ascending address order, same as a single threaded scan.
+     *      A value of 1, the default, scans on the calling thread only, and a value of 0 uses
+     *      one thread per logical core.
+     *
+     * @param threads Number of threads to scan with
+     */
+    void setScanThreads(unsigned threads);
+
+    /**
+     * @brief Priorities `setScheduling` can run a thread at
+     */
+    enum class ThreadPriority {
+        Background, // Lowest CPU, I/O and memory priority, see THREAD_MODE_BACKGROUND_BEGIN
+        Normal,     // THREAD_PRIORITY_NORMAL
+        High,       // THREAD_PRIORITY_HIGHEST
+    };
+
+    /**
+     * @brief How the calling thread and the threads of `patternScan` are scheduled
+     */
+    typedef struct SchedulingPolicy {
+        ThreadPriority priority;
+        bool efficiencyCores; // Restrict the threads to the CPU sets of the efficiency cores
+        bool yield;           // Give up the time slice between two chunks of a scan
+    } SchedulingPolicy;
+
+    /**
+     * @brief Apply a scheduling policy to the calling thread and the threads of `patternScan`
+     * @details The worker threads of every later scan apply the same policy to themselves, so
+     *      they never run at a different priority or on other cores than the thread that set it.
+     *      Efficiency cores are chosen through CPU sets, on a CPU whose cores are all of the
+     *      same efficiency class, or before Windows 10 which has no CPU sets, the threads may
+     *      run on any core. With `yield` set, a scan
+     *      calls `SwitchToThread` after every chunk, or after every section with a single
+     *      scan thread, so the game's own threads get to run in between. Should be called once
+     *      per thread, background mode can't be entered twice.
+     *
+     * @param policy Policy to apply
+     * @return `true` if the whole policy was applied, `false` if the priority or the CPU sets
+     *      could not be set, or efficiency cores were asked for on a CPU without any
+     */
+    bool setScheduling(const SchedulingPolicy& policy);
+
     /**
      * @brief Scan for a given byte pattern on a module
      * @details Obtained and modified from:
@@ -97,10 +468,129 @@ namespace Utils
      *      Original implementation is for the most part intact. Modified so that all
      *      the addresses where the pattern is found is appended to the `address` vector,
      *      instead of returning the address when the first instance is found.
+     *      Candidate positions are located with SSE2 or AVX2 vector compares on the two
+     *      rarest non-wildcard bytes of the pattern, only then is the full pattern compared.
+     *      AVX2 is used when the CPU and OS support it, the remaining tail of the module is
+     *      always compared with the scalar path. A pattern made up of only wildcards, or of
+     *      more than 256 bytes, is never matched.
+     *
+     *      In benchmark builds `ScanKernel::Horspool` can be forced through `setScanKernel`,
+     *      the pattern is then searched with a Horspool skip table built from its longest run
+     *      of non-wildcard bytes, which moves ahead by up to the length of the run whenever the
+     *      byte under its end can't be part of it. It is left out of the DLL, `Auto` never
+     *      picks it and the batch scans the fix runs can't use it.
+     *
+     *      Only the sections listed in the module's section table are scanned, by default
+     *      every section flagged `IMAGE_SCN_MEM_EXECUTE`. Passing a section name, such as
+     *      ".data", scans only that section instead. A match never spans two sections.
+     *      Pages that are not committed, guard pages and pages that can't be read are
+     *      skipped, a match never spans those either. Before scanning, the sections are
+     *      prefetched with `PrefetchVirtualMemory`, so that on a cold start the pages of the
+     *      image that are not resident yet are read in large sequential batches instead of
+     *      one page fault at a time. On Windows 7, which lacks it, nothing is prefetched.
      *
      * @param module Base of the module to search
      * @param signature IDA-style byte array pattern
      * @param address Vector of addresses where the pattern was found
+     * @param section Name of the section to scan, `nullptr` scans all executable sections
+     */
+    void patternScan(void* module, const char* signature, std::vector<uint64_t>* address, const char* section = nullptr);
+
+    /**
+     * @brief Scan for a given byte pattern on a module, reporting matches to a callback
+     * @details Same scan as above, but instead of collecting the matches every address is
+     *      handed to `callback` in ascending order, the scan stops as soon as the callback
+     *      returns `false`. With a single scan thread no memory is allocated at all, the
+     *      pattern is parsed into a fixed buffer on the stack and the callback is called while
+     *      scanning. With more threads the matches are
+     *      buffered per chunk and the callback is called on the calling thread once all chunks
+     *      are done.
+     *
+     * @param module Base of the module to search
+     * @param signature IDA-style byte array pattern
+     * @param callback Function called for every match
+     * @param context User provided pointer passed to `callback`
+     * @param section Name of the section to scan, `nullptr` scans all executable sections
+     * @return Number of matches reported to `callback`
+     */
+    size_t patternScan(void* module, const char* signature, ScanCallback callback, void* context, const char* section = nullptr);
+
+    /**
+     * @brief Scan for the first `count` matches of a byte pattern on a module
+     * @details The scan stops once `count` matches were found, the matches are written into
+     *      the caller provided `address` buffer in ascending order. Signatures that are expected
+     *      to be unique can be found with a `count` of 1, which on average stops the scan
+     *      halfway through the module.
+     *
+     * @param module Base of the module to search
+     * @param signature IDA-style byte array pattern
+     * @param address Buffer that receives the addresses, at least `count` elements long
+     * @param count Maximum number of matches to find
+     * @param section Name of the section to scan, `nullptr` scans all executable sections
+     * @return Number of matches written to `address`
+     */
+    size_t patternScan(void* module, const char* signature, uint64_t* address, size_t count, const char* section = nullptr);
+
+    /**
+     * @brief Scan for the first match of a byte pattern on a module
+     *
+     * @param module Base of the module to search
+     * @param signature IDA-style byte array pattern
+     * @param section Name of the section to scan, `nullptr` scans all executable sections
+     * @return Address of the first match, `std::nullopt` if the pattern was not found
+     */
+    std::optional<uintptr_t> patternScanFirst(void* module, const char* signature, const char* section = nullptr);
+
+    /**
+     * @brief Overloads of the scans above for signatures compiled at build time
+     * @details Behave exactly like their IDA-style string counterparts, without the runtime
+     *      parsing of the pattern.
+     */
+    void patternScan(void* module, const SignatureView& signature, std::vector<uint64_t>* address, const char* section = nullptr);
+    size_t patternScan(void* module, const SignatureView& signature, ScanCallback callback, void* context, const char* section = nullptr);
+    size_t patternScan(void* module, const SignatureView& signature, uint64_t* address, size_t count, const char* section = nullptr);
+    std::optional<uintptr_t> patternScanFirst(void* module, const SignatureView& signature, const char* section = nullptr);
+
+    /**
+     * @brief Scan the writable sections of a module for a pair of 32 bit values
+     * @details Looks for `first` directly followed by `second` at every 4 byte aligned offset of
+     *      every section flagged `IMAGE_SCN_MEM_WRITE`, such as `.data`. Four offsets are
+     *      compared at once with SSE2, the tail of each section with the scalar path. Meant for
+     *      finding where the game keeps values it has already written, the matches are
+     *      written into `address` in ascending order within each section.
+     *
+     * @param module Base of the module to search
+     * @param first Value at the start of the pair
+     * @param second Value 4 bytes after `first`
+     * @param address Buffer that receives the addresses, at least `count` elements long
+     * @param count Maximum number of matches to find
+     * @return Number of matches written to `address`
+     */
+    size_t pairScan(void* module, uint32_t first, uint32_t second, uint64_t* address, size_t count);
+
+    /**
+     * @brief Scan for multiple byte patterns on a module in a single pass
+     * @details Resolves every signature in `signatures` while walking the module only once,
+     *      instead of once per signature. Each signature is keyed on its rarest non-wildcard
+     *      byte, offsets holding one of those bytes are located with vector compares, and only
+     *      the signatures keyed on the byte found there are verified. The addresses where `signatures[i]` was found are appended to
+     *      `address[i]` in ascending order, `address` is resized to match `signatures` if needed.
+     *      A signature made up of only wildcards is never matched. The sections scanned are
+     *      chosen the same way as for the single signature scan. At most `maxMatches` addresses
+     *      are stored per signature, once every signature has that many the scan stops early.
+     *
+     * @param module Base of the module to search
+     * @param signatures IDA-style byte array patterns
+     * @param address Vector of address vectors, one per signature, where the patterns were found
+     * @param maxMatches Maximum number of matches to find per signature
+     * @param section Name of the section to scan, `nullptr` scans all executable sections
+     */
+    void patternScan(void* module, const std::vector<const char*>& signatures, std::vector<std::vector<uint64_t>>* address,
+        size_t maxMatches = SIZE_MAX, const char* section = nullptr);
+
+    /**
+     * @brief Overload of the batch scan above for signatures compiled at build time
      */
-    void patternScan(void* module, const char* signature, std::vector<uint64_t>* address);
+    void patternScan(void* module, const std::vector<SignatureView>& signatures, std::vector<std::vector<uint64_t>>* address,
+        size_t maxMatches = SIZE_MAX, const char* section = nullptr);
 }
@@ -79,6 +79,110 @@ features:
   scaleSprintFov:
     enable: false
     value: 1.0
+
+  # Explanation:
+  #   Limits the frame rate with tighter and more even frame pacing than the game's own frame cap.
+  #   Disable the in game frame cap and vsync when using this.
+  # fps:
+  #   Frame rate to limit to, must be greater than 0
+  frameLimiter:
+    enable: false
+    fps: 144
+
+# Advanced settings, the defaults should work for most users
+advanced:
+
+  # Explanation:
+  #   On startup the fix scans the game for the code it needs to patch.
+  # threads:
+  #   = 0 : scan with one thread per logical core
+  #   > 0 : scan with that many threads, keep this low if the game loads slower with the fix
+  # cache:
+  #   Remembers where the code was found in BorderlandsGOTYEnhancedFix.cache, so later launches
+  #   of the same game version can skip the scan.
+  scanner:
+    threads: 2
+    cache: true
+
+  # Explanation:
+  #   Controls how the threads that start the fix compete with the game, which is loading at
+  #   the same time.
+  # priority:
+  #   background : lowest priority, for disk access as well, the game loads first
+  #   normal     : same priority as the game's own threads
+  #   high       : above the game's own threads, startup of the fix finishes first
+  # efficiencyCores:
+  #   Runs startup only on the efficiency cores of CPUs that have them, leaving the performance
+  #   cores to the game.
+  # yield:
+  #   Lets other threads run in between every part of the scan.
+  scheduling:
+    priority: normal
+    efficiencyCores: false
+    yield: false
+
+  # Explanation:
+  #   Before applying the fixes the fix waits for the game to finish setting up its resolution.
+  # timeout:
+  #   Maximum time to wait in milliseconds, the fixes are applied anyway once it runs out.
+  startup:
+    timeout: 5000
+
+  # Explanation:
+  #   Controls how BorderlandsGOTYEnhancedFix.log is written.
+  # async:
+  #   Writes the log from a background thread so logging never waits on the disk. Can hang the
+  #   game when it exits, leave it disabled unless the log slows the game down.
+  # level:
+  #   Lowest level that is logged, one of trace, debug, info, warn, err, critical or off.
+  #   Logging from inside hooks needs debug, and a build with ENABLE_HOOK_LOG turned on.
+  logging:
+    async: false
+    level: info
+
+  # Explanation:
+  #   Reloads this file when it is saved while the game is running. Only the values of the FOV
+  #   fix and the sprint FOV feature are reloaded, and only the ones enabled at startup have an
+  #   effect. Everything else needs a restart of the game.
+  reload:
+    enable: true
+
+  # Explanation:
+  #   Counts how often every hook runs and how long it takes, and logs a summary of that.
+  #   Only useful for debugging, leave it disabled otherwise.
+  # interval:
+  #   Seconds between summaries, must be greater than 0.
+  stats:
+    enable: false
+    interval: 60
+
+  # Explanation:
+  #   Writes the time of every frame to BorderlandsGOTYEnhancedFix.frametimes.csv, to compare
+  #   frame pacing with and without the fixes. This works even when masterEnable is false.
+  #   Only useful for debugging, leave it disabled otherwise.
+  frameTimes:
+    enable: false
+
+  # Explanation:
+  #   Controls how the fixes modify the game's code.
+  # directPatch:
+  #   Fixes that only set a register to the chosen resolution patch the game's code directly,
+  #   instead of hooking it. Slightly cheaper, but these fixes no longer show up in stats.
+  hooks:
+    directPatch: false
+
+  # Explanation:
+  #   How long every phase of startup took is always logged. This also writes it to
+  #   BorderlandsGOTYEnhancedFix.timing.json, to compare startup times between machines.
+  #   Only useful for debugging, leave it disabled otherwise.
+  timing:
+    json: false
+
+  # Explanation:
+  #   Publishes how often every hook runs, how long it takes, and the time of every frame in
+  #   shared memory, for monitoring tools to read while the game runs. See the README.
+  telemetry:
+    enable: false
 "@
 
 if (Test-Path -Path $gameFolder) {
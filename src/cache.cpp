@@ -0,0 +1,156 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <format>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "cache.hpp"
+
+namespace
+{
+    /*
+     * First line of every cache file, bump the version whenever the format changes so that
+     * files written by an older version are discarded instead of misread.
+     */
+    constexpr const char* cacheHeader = "BorderlandsGOTYEnhancedFix signature cache v1";
+
+    uint8_t* base = nullptr;
+    Cache::identity_t identity = {};
+    std::unordered_map<std::string, uint32_t> entries;
+    bool dirty = false;
+}
+
+namespace Cache
+{
+    identity_t getIdentity(void* module) {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        auto sectionHeader = IMAGE_FIRST_SECTION(ntHeaders);
+
+        identity_t id = {};
+        id.timeDateStamp = ntHeaders->FileHeader.TimeDateStamp;
+        id.sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+        id.textChecksum = 0xCBF29CE484222325;
+        for (WORD i = 0; i < ntHeaders->FileHeader.NumberOfSections; i++, sectionHeader++) {
+            if (strncmp((const char*)sectionHeader->Name, ".text", IMAGE_SIZEOF_SHORT_NAME) != 0) {
+                continue;
+            }
+            auto text = (const uint8_t*)module + sectionHeader->VirtualAddress;
+            size_t size = std::min<size_t>(sectionHeader->Misc.VirtualSize, id.sizeOfImage - sectionHeader->VirtualAddress);
+            for (size_t j = 0; j + sizeof(uint64_t) <= size; j += sizeof(uint64_t)) {
+                uint64_t word;
+                memcpy(&word, &text[j], sizeof(word));
+                id.textChecksum = (id.textChecksum ^ word) * 0x100000001B3;
+            }
+            break;
+        }
+        return id;
+    }
+
+    bool load(void* module, const char* path) {
+        base = (uint8_t*)module;
+        identity = getIdentity(module);
+        entries.clear();
+        dirty = true;
+
+        std::ifstream file(path);
+        std::string line;
+        if (!std::getline(file, line) || line != cacheHeader) {
+            return false;
+        }
+        identity_t cached = {};
+        if (!std::getline(file, line)
+            || sscanf_s(line.c_str(), "%lx %lx %llx", &cached.timeDateStamp, &cached.sizeOfImage, &cached.textChecksum) != 3
+            || cached.timeDateStamp != identity.timeDateStamp
+            || cached.sizeOfImage != identity.sizeOfImage
+            || cached.textChecksum != identity.textChecksum) {
+            return false;
+        }
+        while (std::getline(file, line)) {
+            // Each entry is the RVA in hex, a single space, and then the signature string as is
+            auto split = line.find(' ');
+            if (split == std::string::npos) {
+                continue;
+            }
+            entries[line.substr(split + 1)] = (uint32_t)strtoul(line.substr(0, split).c_str(), nullptr, 16);
+        }
+        dirty = false;
+        return true;
+    }
+
+    std::optional<uintptr_t> find(const Utils::SignatureView& signature) {
+        auto entry = entries.find(signature.string);
+        if (entry == entries.end()) {
+            return std::nullopt;
+        }
+        uint32_t rva = entry->second;
+        if (rva + signature.size > identity.sizeOfImage || !signature.matches(base + rva, signature)) {
+            entries.erase(entry);
+            dirty = true;
+            return std::nullopt;
+        }
+        return (uintptr_t)base + rva;
+    }
+
+    void store(const Utils::SignatureView& signature, uintptr_t address) {
+        entries[signature.string] = (uint32_t)(address - (uintptr_t)base);
+        dirty = true;
+    }
+
+    std::optional<uintptr_t> findAddress(const char* name) {
+        auto entry = entries.find(name);
+        if (entry == entries.end() || entry->second >= identity.sizeOfImage) {
+            return std::nullopt;
+        }
+        return (uintptr_t)base + entry->second;
+    }
+
+    void storeAddress(const char* name, uintptr_t address) {
+        entries[name] = (uint32_t)(address - (uintptr_t)base);
+        dirty = true;
+    }
+
+    bool save(const char* path) {
+        if (!dirty) {
+            return true;
+        }
+        std::ofstream file(path, std::ios::trunc);
+        file << cacheHeader << '\n';
+        file << std::format("{:x} {:x} {:x}\n", identity.timeDateStamp, identity.sizeOfImage, identity.textChecksum);
+        for (auto& [signature, rva] : entries) {
+            file << std::format("{:x} {}\n", rva, signature);
+        }
+        dirty = !file.good();
+        return !dirty;
+    }
+}
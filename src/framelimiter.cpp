@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <cstdint>
+
+#include "present.hpp"
+#include "framelimiter.hpp"
+
+namespace
+{
+    HANDLE timer = nullptr;
+    int64_t frequency = 0;
+    int64_t period = 0;
+    int64_t spin = 0;
+    int64_t deadline = 0;
+
+    /*
+     * How long before a deadline to stop waiting on the timer and start spinning, high
+     * resolution timers wake up within a few hundred microseconds, regular ones can be late
+     * by the full system timer resolution.
+     */
+    constexpr double highResolutionSpinMs = 0.5;
+    constexpr double lowResolutionSpinMs = 2.0;
+
+    int64_t now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    void onPresent(IDXGISwapChain* swapChain, void* context) {
+        int64_t current = now();
+        if (deadline == 0 || current >= deadline) {
+            // First or late frame, do not hold it back and start over from here
+            deadline = current + period;
+            return;
+        }
+
+        int64_t wait = deadline - current - spin;
+        if (wait > 0) {
+            // Relative due times are negative, in 100ns units
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -(wait * 10000000 / frequency);
+            if (SetWaitableTimer(timer, &dueTime, 0, NULL, NULL, FALSE)) {
+                WaitForSingleObject(timer, INFINITE);
+            }
+        }
+        while (now() < deadline) {
+            YieldProcessor();
+        }
+        deadline += period;
+    }
+}
+
+namespace FrameLimiter
+{
+    bool start(double fps) {
+        if (fps <= 0.0) {
+            return false;
+        }
+        double spinMs = highResolutionSpinMs;
+        timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!timer) {
+            spinMs = lowResolutionSpinMs;
+            timer = CreateWaitableTimerExW(NULL, NULL, 0, TIMER_ALL_ACCESS);
+        }
+        if (!timer) {
+            return false;
+        }
+
+        LARGE_INTEGER counterFrequency;
+        QueryPerformanceFrequency(&counterFrequency);
+        frequency = counterFrequency.QuadPart;
+        period = (int64_t)((double)frequency / fps);
+        spin = (int64_t)((double)frequency * spinMs / 1000.0);
+        if (!Present::addCallback(onPresent)) {
+            CloseHandle(timer);
+            timer = nullptr;
+            return false;
+        }
+        return true;
+    }
+}
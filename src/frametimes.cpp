@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <atomic>
+#include <fstream>
+#include <format>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+#include "present.hpp"
+#include "frametimes.hpp"
+
+namespace
+{
+    typedef struct frame_t {
+        int64_t timestamp;
+        uint32_t dropped;
+    } frame_t;
+
+    /*
+     * Single producer single consumer ring buffer, the render thread pushes and the writer
+     * thread pops. At 1000 frames per second and 4 drains per second it is a quarter full.
+     */
+    constexpr size_t capacity = 1024;
+    frame_t frames[capacity];
+    std::atomic<size_t> head = 0;
+    std::atomic<size_t> tail = 0;
+    uint32_t dropped = 0;
+
+    constexpr auto drainInterval = std::chrono::milliseconds(250);
+
+    void onPresent(IDXGISwapChain* swapChain, void* context) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == capacity) {
+            dropped++;
+            return;
+        }
+        frames[h % capacity] = { now.QuadPart, dropped };
+        dropped = 0;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    void writer(std::ofstream file) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        double toMs = 1000.0 / (double)frequency.QuadPart;
+
+        uint64_t frame = 0;
+        int64_t first = 0;
+        int64_t previous = 0;
+        while (true) {
+            std::this_thread::sleep_for(drainInterval);
+            size_t h = head.load(std::memory_order_acquire);
+            for (size_t t = tail.load(std::memory_order_relaxed); t != h; t++) {
+                const frame_t& current = frames[t % capacity];
+                if (frame == 0) {
+                    first = current.timestamp;
+                }
+                double timestamp = (double)(current.timestamp - first) * toMs;
+                if (frame == 0 || current.dropped) {
+                    file << std::format("{},{:.3f},,{}\n", frame, timestamp, current.dropped);
+                }
+                else {
+                    double frameTime = (double)(current.timestamp - previous) * toMs;
+                    file << std::format("{},{:.3f},{:.3f},0\n", frame, timestamp, frameTime);
+                }
+                previous = current.timestamp;
+                frame++;
+            }
+            tail.store(h, std::memory_order_release);
+            file.flush();
+        }
+    }
+}
+
+namespace FrameTimes
+{
+    bool start(const char* path) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        if (!Present::addCallback(onPresent)) {
+            return false;
+        }
+        file << "frame,timestamp_ms,frametime_ms,dropped\n";
+        std::thread(writer, std::move(file)).detach();
+        return true;
+    }
+}
@@ -0,0 +1,330 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "safetyhook.hpp"
+#include "Zydis/Zydis.h"
+
+#include "hooks.hpp"
+
+namespace
+{
+    constexpr uint8_t movEax = 0xB8;
+    constexpr uint8_t jmpRel32 = 0xE9;
+    constexpr uint8_t ret = 0xC3;
+    constexpr uint8_t int3 = 0xCC;
+    constexpr uint8_t nop = 0x90;
+    constexpr size_t movEaxSize = 5;
+    constexpr size_t jmpSize = 5;
+
+    /*
+     * How far past the anchor `Hooks::resolveSite` looks for the site, the sites are all within
+     * a couple of instructions of their signature.
+     */
+    constexpr size_t maxSiteDistance = 64;
+
+    void emitMovEax(std::vector<uint8_t>& code, uint32_t value) {
+        code.push_back(movEax);
+        code.insert(code.end(), (uint8_t*)&value, (uint8_t*)&value + sizeof(value));
+    }
+
+    void emitJmp(std::vector<uint8_t>& code, uint8_t* from, uint8_t* to) {
+        int32_t rel = (int32_t)(to - (from + jmpSize));
+        code.push_back(jmpRel32);
+        code.insert(code.end(), (uint8_t*)&rel, (uint8_t*)&rel + sizeof(rel));
+    }
+
+    bool canMove(const ZydisDecodedInstruction& instruction) {
+        switch (instruction.meta.category) {
+        case ZYDIS_CATEGORY_CALL:
+        case ZYDIS_CATEGORY_COND_BR:
+        case ZYDIS_CATEGORY_UNCOND_BR:
+        case ZYDIS_CATEGORY_RET:
+        case ZYDIS_CATEGORY_INTERRUPT:
+        case ZYDIS_CATEGORY_SYSTEM:
+            return false;
+        default:
+            break;
+        }
+        // A relative immediate can not be moved, a RIP relative displacement can be relocated
+        return !(instruction.raw.imm[0].is_relative || instruction.raw.imm[1].is_relative);
+    }
+
+    /*
+     * Remembers where `instruction` at `address` branches to, if it is a relative jmp or jcc.
+     */
+    void addBranchTarget(std::vector<uint8_t*>& targets, const ZydisDecodedInstruction& instruction,
+        const ZydisDecodedOperand* operands, uint8_t* address
+    ) {
+        if (instruction.meta.category != ZYDIS_CATEGORY_COND_BR && instruction.meta.category != ZYDIS_CATEGORY_UNCOND_BR) {
+            return;
+        }
+        for (ZyanU8 i = 0; i < instruction.operand_count_visible; i++) {
+            ZyanU64 absolute;
+            if (operands[i].type == ZYDIS_OPERAND_TYPE_IMMEDIATE && operands[i].imm.is_relative &&
+                ZYAN_SUCCESS(ZydisCalcAbsoluteAddress(&instruction, &operands[i], (ZyanU64)address, &absolute))
+            ) {
+                targets.push_back((uint8_t*)absolute);
+            }
+        }
+    }
+
+    bool siteMatches(const ZydisDecodedInstruction& instruction, const ZydisDecodedOperand* operands, const Hooks::Site& site) {
+        if (instruction.mnemonic != site.mnemonic) {
+            return false;
+        }
+        if (site.source != ZYDIS_REGISTER_NONE) {
+            if (instruction.operand_count_visible < 2 ||
+                operands[1].type != ZYDIS_OPERAND_TYPE_REGISTER ||
+                operands[1].reg.value != site.source
+            ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * Checks that a jmp can be written over the first 5 bytes at `site`, see `Hooks::resolveSite`.
+     * Returns why it can't, or `nullptr` if it can. `padded` is cleared if the bytes after a ret
+     * or jmp in those 5 bytes are not padding, which is only reported, not rejected.
+     */
+    const char* checkSite(const ZydisDecoder& decoder, uint8_t* site, std::vector<uint8_t*>& targets, bool& padded) {
+        ZydisDecodedInstruction instruction;
+        ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
+        size_t covered = 0;
+        bool ended = false;
+        padded = true;
+        while (covered < jmpSize) {
+            if (ended) {
+                padded &= site[covered] == int3 || site[covered] == nop;
+                covered++;
+                continue;
+            }
+            if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, site + covered, ZYDIS_MAX_INSTRUCTION_LENGTH, &instruction, operands))) {
+                return "the instructions it overwrites do not decode";
+            }
+            addBranchTarget(targets, instruction, operands, site + covered);
+            ended = instruction.meta.category == ZYDIS_CATEGORY_RET || instruction.meta.category == ZYDIS_CATEGORY_UNCOND_BR;
+            covered += instruction.length;
+        }
+        for (uint8_t* target : targets) {
+            if (target > site && target < site + jmpSize) {
+                return "a branch lands within the bytes it overwrites";
+            }
+        }
+        return nullptr;
+    }
+
+    /*
+     * Copies `instruction` from `from` to the end of `code`, which will be at `to`, fixing up a
+     * RIP relative displacement so it still points at the same address.
+     */
+    bool relocate(std::vector<uint8_t>& code, const ZydisDecodedInstruction& instruction,
+        const ZydisDecodedOperand* operands, uint8_t* from, uint8_t* to
+    ) {
+        size_t start = code.size();
+        code.insert(code.end(), from, from + instruction.length);
+        if (!(instruction.attributes & ZYDIS_ATTRIB_IS_RELATIVE)) {
+            return true;
+        }
+        for (ZyanU8 i = 0; i < instruction.operand_count; i++) {
+            const ZydisDecodedOperand& operand = operands[i];
+            if (operand.type != ZYDIS_OPERAND_TYPE_MEMORY || operand.mem.base != ZYDIS_REGISTER_RIP) {
+                continue;
+            }
+            ZyanU64 absolute;
+            if (instruction.raw.disp.size != 32 ||
+                !ZYAN_SUCCESS(ZydisCalcAbsoluteAddress(&instruction, &operand, (ZyanU64)from, &absolute))
+            ) {
+                return false;
+            }
+            int64_t disp = (int64_t)absolute - (int64_t)(to + instruction.length);
+            if (disp != (int32_t)disp) {
+                return false;
+            }
+            int32_t disp32 = (int32_t)disp;
+            memcpy(&code[start + instruction.raw.disp.offset], &disp32, sizeof(disp32));
+        }
+        return true;
+    }
+}
+
+namespace Hooks
+{
+    void* resolveSite(void* anchor, const Site& site, const char** problem) {
+        const char* unused;
+        problem = problem ? problem : &unused;
+        *problem = nullptr;
+        ZydisDecoder decoder;
+        ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+        ZydisDecodedInstruction instruction;
+        ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
+        std::vector<uint8_t*> targets;
+
+        bool follows = site.after == ZYDIS_MNEMONIC_INVALID;
+        for (uint8_t* address = (uint8_t*)anchor; address < (uint8_t*)anchor + maxSiteDistance; address += instruction.length) {
+            if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, address, ZYDIS_MAX_INSTRUCTION_LENGTH, &instruction, operands))) {
+                *problem = "the code after the signature does not decode";
+                return nullptr;
+            }
+            if (follows && siteMatches(instruction, operands, site)) {
+                bool padded;
+                *problem = checkSite(decoder, address, targets, padded);
+                if (*problem) {
+                    return nullptr;
+                }
+                if (!padded) {
+                    *problem = "the bytes after its ret or jmp are not int3 or nop padding";
+                }
+                return address;
+            }
+            addBranchTarget(targets, instruction, operands, address);
+            follows |= instruction.mnemonic == site.after;
+        }
+        *problem = "no matching instruction within 64 bytes";
+        return nullptr;
+    }
+
+    bool Batch::add(void* target, safetyhook::MidHookFn destination) {
+        SafetyHookMid hook = safetyhook::create_mid(target, destination, safetyhook::MidHook::StartDisabled);
+        if (!hook) {
+            return false;
+        }
+        hooks.push_back(std::move(hook));
+        return true;
+    }
+
+    bool Batch::addMovEax(void* target, uint32_t value) {
+        ZydisDecoder decoder;
+        ZydisDecoderInit(&decoder, ZYDIS_MACHINE_MODE_LONG_64, ZYDIS_STACK_WIDTH_64);
+        ZydisDecodedInstruction instruction;
+        ZydisDecodedOperand operands[ZYDIS_MAX_OPERAND_COUNT];
+        uint8_t* site = (uint8_t*)target;
+
+        if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, site, ZYDIS_MAX_INSTRUCTION_LENGTH, &instruction, operands))) {
+            return false;
+        }
+
+        // A ret followed by padding has room for `mov eax, value; ret` right where it is
+        if (instruction.meta.category == ZYDIS_CATEGORY_RET) {
+            if (instruction.length != 1 || site[0] != ret) {
+                return false;
+            }
+            for (size_t i = 1; i <= movEaxSize; i++) {
+                if (site[i] != int3) {
+                    return false;
+                }
+            }
+            patch_t patch = { site, {}, nullptr, 1 };
+            emitMovEax(patch.bytes, value);
+            patch.bytes.push_back(ret);
+            patches.push_back(std::move(patch));
+            return true;
+        }
+
+        // Everything else has to make room for a jmp to a cave
+        auto allocation = safetyhook::Allocator::global()->allocate_near({ site }, movEaxSize + 2 * ZYDIS_MAX_INSTRUCTION_LENGTH + jmpSize);
+        if (!allocation) {
+            return false;
+        }
+        uint8_t* cave = allocation->data();
+        std::vector<uint8_t> code;
+        emitMovEax(code, value);
+        size_t displaced = 0;
+        while (displaced < jmpSize) {
+            if (!ZYAN_SUCCESS(ZydisDecoderDecodeFull(&decoder, site + displaced, ZYDIS_MAX_INSTRUCTION_LENGTH, &instruction, operands)) ||
+                !canMove(instruction) ||
+                !relocate(code, instruction, operands, site + displaced, cave + code.size())
+            ) {
+                return false;
+            }
+            displaced += instruction.length;
+        }
+        emitJmp(code, cave + code.size(), site + displaced);
+        memcpy(cave, code.data(), code.size());
+
+        patch_t patch = { site, {}, cave, displaced };
+        emitJmp(patch.bytes, site, cave);
+        patch.bytes.resize(displaced, nop);
+        patches.push_back(std::move(patch));
+        caves.push_back(std::move(*allocation));
+        return true;
+    }
+
+    size_t Batch::commit() {
+        if (pending() == 0) {
+            return 0;
+        }
+        size_t enabled = 0;
+        // Enabling allocates and takes safetyhook's locks, so it runs its own freeze outside ours
+        for (size_t i = committed; i < hooks.size(); i++) {
+            if (hooks[i].enable()) {
+                enabled++;
+            }
+        }
+        committed = hooks.size();
+        if (committedPatches == patches.size()) {
+            return enabled;
+        }
+        safetyhook::execute_while_frozen(
+            [this, &enabled]() {
+                for (size_t i = committedPatches; i < patches.size(); i++) {
+                    patch_t& patch = patches[i];
+                    DWORD oldProtect;
+                    VirtualProtect(patch.target, patch.bytes.size(), PAGE_EXECUTE_READWRITE, &oldProtect);
+                    memcpy(patch.target, patch.bytes.data(), patch.bytes.size());
+                    VirtualProtect(patch.target, patch.bytes.size(), oldProtect, &oldProtect);
+                    FlushInstructionCache(GetCurrentProcess(), patch.target, patch.bytes.size());
+                    enabled++;
+                }
+            },
+            [this](safetyhook::ThreadId, safetyhook::ThreadHandle, safetyhook::ThreadContext threadContext) {
+                // Move threads stopped on moved instructions to their copy in the cave
+                auto context = (CONTEXT*)threadContext;
+                for (size_t i = committedPatches; i < patches.size(); i++) {
+                    patch_t& patch = patches[i];
+                    uintptr_t begin = (uintptr_t)patch.target;
+                    if (patch.cave && context->Rip >= begin && context->Rip < begin + patch.displaced) {
+                        context->Rip = context->Rip == begin
+                            ? (uintptr_t)patch.cave
+                            : (uintptr_t)patch.cave + movEaxSize + (context->Rip - begin);
+                    }
+                }
+            }
+        );
+        committedPatches = patches.size();
+        return enabled;
+    }
+
+    size_t Batch::pending() const {
+        return hooks.size() - committed + patches.size() - committedPatches;
+    }
+}
@@ -24,29 +24,66 @@
 
 // System includes
 #include <windows.h>
+#include <shlobj.h>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <format>
+#include <cstring>
+#include <initializer_list>
 #include <filesystem>
 #include <numeric>
 #include <numbers>
 #include <cmath>
 #include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string_view>
 
 // 3rd party includes
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/async.h"
 #include "yaml-cpp/yaml.h"
 #include "safetyhook.hpp"
 
 // Local includes
 #include "utils.hpp"
+#include "cache.hpp"
+#include "stats.hpp"
+#include "signatures.hpp"
+#include "present.hpp"
+#include "frametimes.hpp"
+#include "hooks.hpp"
+#include "framelimiter.hpp"
+#include "timing.hpp"
+#include "trace.hpp"
 
 // Defines
 #define VERSION "2.1.0"
+#define YML_NAME "BorderlandsGOTYEnhancedFix.yml"
+#define YML_CACHE_NAME "BorderlandsGOTYEnhancedFix.yml.cache"
 
 // Macros
 #define LOG(STRING, ...) spdlog::info("{} : " STRING, __func__, ##__VA_ARGS__)
+#define WARN(STRING, ...) spdlog::warn("{} : " STRING, __func__, ##__VA_ARGS__)
+
+/*
+ * Logging from inside a hook happens on the game's threads, every time the hook runs. It is
+ * only compiled in when ENABLE_HOOK_LOG is defined, and then only logs at the debug level,
+ * so it costs nothing unless it was explicitly turned on for debugging.
+ */
+#ifdef ENABLE_HOOK_LOG
+#define HOOK_LOG(STRING, ...) \
+    do { \
+        if (spdlog::should_log(spdlog::level::debug)) { \
+            spdlog::debug("{} : " STRING, __func__, ##__VA_ARGS__); \
+        } \
+    } while (0)
+#else
+#define HOOK_LOG(STRING, ...) do {} while (0)
+#endif
 
 // .yml to struct
 typedef struct resolution_t {
@@ -68,23 +105,153 @@ typedef struct scaleSprintFov_t {
     float value;
 } scaleSprintFov_t;
 
+typedef struct frameLimiter_t {
+    bool enable;
+    float fps;
+} frameLimiter_t;
+
 typedef struct feature_t {
     scaleSprintFov_t scaleSprintFov;
+    frameLimiter_t frameLimiter;
 } feature_t;
 
+typedef struct scanner_t {
+    int threads;
+    bool cache;
+} scanner_t;
+
+typedef struct startup_t {
+    int timeout;
+} startup_t;
+
+typedef struct logging_t {
+    bool async;
+    std::string level;
+} logging_t;
+
+typedef struct reload_t {
+    bool enable;
+} reload_t;
+
+typedef struct stats_t {
+    bool enable;
+    int interval;
+} stats_t;
+
+typedef struct frameTimes_t {
+    bool enable;
+} frameTimes_t;
+
+typedef struct timing_t {
+    bool json;
+} timing_t;
+
+typedef struct hooks_t {
+    bool directPatch;
+} hooks_t;
+
+typedef struct telemetry_t {
+    bool enable;
+} telemetry_t;
+
+typedef struct scheduling_t {
+    Utils::ThreadPriority priority;
+    bool efficiencyCores;
+    bool yield;
+} scheduling_t;
+
+typedef struct advanced_t {
+    scanner_t scanner;
+    scheduling_t scheduling;
+    startup_t startup;
+    logging_t logging;
+    reload_t reload;
+    stats_t stats;
+    frameTimes_t frameTimes;
+    hooks_t hooks;
+    timing_t timing;
+    telemetry_t telemetry;
+} advanced_t;
+
 typedef struct yml_t {
     std::string name;
     bool masterEnable;
     resolution_t resolution;
     fix_t fix;
     feature_t feature;
+    advanced_t advanced;
 } yml_t;
 
+/*
+ * Values used for every key that is missing from the yml file, or that holds a value of the
+ * wrong type. They match the yml file written by install.ps1.
+ */
+const yml_t ymlDefaults = {
+    .name = "Borderlands GOTY Enhanced Fix",
+    .masterEnable = true,
+    .resolution = { 0, 0, 0.0f },
+    .fix = {
+        .fov = { true, 90.0f },
+    },
+    .feature = {
+        .scaleSprintFov = { false, 1.0f },
+        .frameLimiter = { false, 144.0f },
+    },
+    .advanced = {
+        .scanner = { 2, true },
+        .scheduling = { Utils::ThreadPriority::Normal, false, false },
+        .startup = { 5000 },
+        .logging = { false, "info" },
+        .reload = { true },
+        .stats = { false, 60 },
+        .frameTimes = { false },
+        .hooks = { false },
+        .timing = { false },
+        .telemetry = { false },
+    },
+};
+
+/*
+ * Layout of YML_CACHE_NAME, the parsed and validated contents of the yml file. It is only
+ * used while the modification time and size of the yml file match `writeTime` and `size`,
+ * a launch with an unchanged yml file this way never has to run yaml-cpp at all. Bump
+ * `ymlCacheVersion` whenever the layout changes.
+ */
+constexpr uint32_t ymlCacheMagic = 0x43594742; // "BGYC"
+constexpr uint32_t ymlCacheVersion = 3;
+
+typedef struct yml_cache_t {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t writeTime;
+    uint64_t size;
+    char name[128];
+    bool masterEnable;
+    resolution_t resolution;
+    fix_t fix;
+    feature_t feature;
+    scanner_t scanner;
+    scheduling_t scheduling;
+    startup_t startup;
+    bool loggingAsync;
+    char loggingLevel[16];
+    reload_t reload;
+    stats_t stats;
+    frameTimes_t frameTimes;
+    hooks_t hooks;
+    timing_t timing;
+    telemetry_t telemetry;
+} yml_cache_t;
+
 // Globals
 HMODULE baseModule = GetModuleHandle(NULL);
-YAML::Node config = YAML::LoadFile("BorderlandsGOTYEnhancedFix.yml");
 yml_t yml;
 
+/*
+ * Where the configuration in `yml` came from, logged by `logYml()` once the logger exists.
+ */
+std::string ymlSource;
+
 float nativeAspectRatio = 16.0f / 9.0f;
 
 /*
@@ -93,21 +260,130 @@ float nativeAspectRatio = 16.0f / 9.0f;
  */
 float inGameSetFov = 120.0f;
 
+/*
+ * Everything the hooks read while the game runs, precomputed from the config so that it all
+ * fits in one cache line. A hook touches two lines, the one holding `hotState` and the one of
+ * the hot state it points to. A hot state is never modified once it has been published through
+ * `hotState`, reloading the yml file publishes a new one instead, see `publishHotState()`. This
+ * way a hook never has to take a lock and never sees half a reload. The pointer is aligned to
+ * the start of a cache line, globals placed after it may still share that line. Old hot
+ * states are kept in `hotStates` as a hook may still be reading them, the yml file is only
+ * reloaded when it is edited so there are only ever a few of them.
+ */
+typedef struct alignas(64) hot_state_t {
+    float fovScale;           // Master FOV controller factor, see `computeFovScale()`
+    float sprintFovScale;     // Factor the sprint FOV delta is scaled by
+    float inGameSetFov;       // FOV the sprint FOV delta is taken from
+    uint32_t width;           // Resolution width
+    uint32_t height;          // Resolution height
+    uint32_t aspectClamp;     // Height the aspect ratio clamp returns
+} hot_state_t;
+static_assert(sizeof(hot_state_t) == 64);
+alignas(64) std::atomic<const hot_state_t*> hotState = nullptr;
+std::vector<std::unique_ptr<hot_state_t>> hotStates;
+
+/*
+ * The game keeps the resolution chosen in the launcher as a width and height pair in several
+ * slots of its .data section, this is where the first one was in the build the fix was made
+ * for. The other slots are at `resSlotLayout` from the first one, see `findResolutionSlots()`.
+ */
+constexpr uintptr_t resSlotRva = 0x25E50A0;
+constexpr uintptr_t resSlotLayout[] = { 0x0, 0x690, 0xBC8, 0x1100, 0x1638, 0x18D4, 0x1B70 };
+const char* const resSlotCacheName = "resolution slots";
+
+const char* const cacheName = "BorderlandsGOTYEnhancedFix.cache";
+
+/*
+ * Folder the DLL was loaded from, which is where install.ps1 puts the yml file, set by
+ * `DllMain()`. Every file the fix reads or writes lives there. The ASI loader only changes the
+ * working directory to that folder while it loads plugins and restores it after, `Main()` runs
+ * on its own thread and can't rely on it.
+ */
+std::filesystem::path dllDirectory;
+
+/**
+ * @brief Gets the absolute path of a file next to the DLL.
+ *
+ * @param name Name of the file.
+ * @return Path of `name` in `dllDirectory`, just `name` if the folder is not known.
+ */
+std::string dllFile(const char* name) {
+    return (dllDirectory / name).string();
+}
+
+/*
+ * Where every signature in `signatures` was found, at the same index, see `scanSignatures()`.
+ */
+std::vector<std::vector<uint64_t>> signatureHits;
+
+/*
+ * Every mid hook and direct patch of the fixes and features is added here, and installed by
+ * `applyFixes()` after all fixes and features ran. The mid hooks are enabled one by one, each
+ * in the freeze safetyhook runs for it, the direct patches share one freeze, see `Hooks::Batch`.
+ */
+Hooks::Batch hooks;
+
+/*
+ * How a fix changes the game's code at its hook site.
+ */
+enum hook_kind_t {
+    MidHook,    // Runs `callback` as a mid hook
+    MovEax,     // Sets eax to `value`, as a direct patch if enabled, `callback` otherwise
+};
+
+/*
+ * Describes one hook of a fix or feature. The fixes and features add a descriptor for each of
+ * their hooks to `fixRegistry`, after which `scanSignatures()` resolves the signatures of all
+ * enabled ones together and `applyFixes()` installs all of their hooks from one batch. A new fix
+ * only has to add its descriptors to get the signature cache, the single scan and the batched
+ * install for free.
+ */
+typedef struct fix_desc_t {
+    const char* name;                   // Logged when the fix is applied
+    signature_t signature;              // Signature the hook site is found with
+    Hooks::Site site;                   // Instruction after the signature that is hooked
+    hook_kind_t kind;
+    safetyhook::MidHookFn callback;     // Mid hook body, also the fallback for MovEax
+    uint32_t value;                     // Value to set eax to for MovEax
+    bool (*enabled)(const yml_t& cfg);  // Whether the hook is applied
+} fix_desc_t;
+std::vector<fix_desc_t> fixRegistry;
+
 /**
  * @brief Initializes logging for the application.
  *
  * This function performs the following tasks:
- * 1. Initializes the spdlog logging library and sets up a file logger.
+ * 1. Initializes the spdlog logging library and sets up a file logger, which is synchronous
+ *      unless `advanced.logging.async` is set, with the level from the logging options in `yml`.
+ *
+ * @details
+ * spdlog's thread pool and flush worker are joined by static destructors when the game exits,
+ * under the loader lock and after the threads may already have been killed, which can hang the
+ * game on exit. That's why the asynchronous logger is opt-in.
  * 2. Retrieves and logs the path and name of the executable module.
  * 3. Logs detailed information about the module to aid in debugging.
  *
  * @return void
  */
 void logInit() {
+    Timing::Phase phase(__func__);
     // spdlog initialisation
-    auto logger = spdlog::basic_logger_mt("BorderlandsGOTYEnhanced", "BorderlandsGOTYEnhancedFix.log", true);
-    spdlog::set_default_logger(logger);
-    spdlog::flush_on(spdlog::level::debug);
+    std::shared_ptr<spdlog::logger> logger;
+    if (yml.advanced.logging.async) {
+        // Messages are queued and written by a background thread, when the queue is full the
+        // oldest messages are dropped instead of blocking the thread that logs
+        spdlog::init_thread_pool(8192, 1);
+        logger = spdlog::basic_logger_mt<spdlog::async_factory_nonblock>("BorderlandsGOTYEnhanced", dllFile("BorderlandsGOTYEnhancedFix.log"), true);
+        spdlog::set_default_logger(logger);
+        spdlog::flush_on(spdlog::level::warn);
+        spdlog::flush_every(std::chrono::seconds(1));
+    }
+    else {
+        logger = spdlog::basic_logger_mt("BorderlandsGOTYEnhanced", dllFile("BorderlandsGOTYEnhancedFix.log"), true);
+        spdlog::set_default_logger(logger);
+        spdlog::flush_on(spdlog::level::debug);
+    }
+    spdlog::set_level(spdlog::level::from_str(yml.advanced.logging.level));
 
     // Get game name and exe path
     WCHAR exePath[_MAX_PATH] = { 0 };
@@ -126,28 +402,301 @@ void logInit() {
 }
 
 /**
- * @brief Reads and parses configuration settings from a YAML file.
+ * @brief Reads the value at `path` in a YAML document.
  *
- * This function performs the following tasks:
- * 1. Reads general settings from the configuration file and assigns them to the `yml` structure.
- * 2. Initializes global settings if certain values are missing or default.
- * 3. Logs the parsed configuration values for debugging purposes.
+ * @details
+ * yaml-cpp nodes are references into the document, assigning one node to another overwrites
+ * the value the left hand side refers to instead of rebinding it. The walk therefore only
+ * ever rebinds its cursor with `Node::reset()`, which leaves the document untouched.
+ *
+ * @param root Root of the document.
+ * @param path Keys leading to the value, outermost first.
+ * @param fallback Value returned if a key is missing or the value has the wrong type.
+ * @return The value at `path`, `fallback` if there is none.
+ */
+template<typename T>
+T ymlValue(const YAML::Node& root, std::initializer_list<const char*> path, const T& fallback) {
+    YAML::Node node;
+    node.reset(root);
+    for (const char* key : path) {
+        if (!node.IsMap()) {
+            return fallback;
+        }
+        const YAML::Node& parent = node;
+        const YAML::Node child = parent[key];
+        if (!child.IsDefined()) {
+            return fallback;
+        }
+        node.reset(child);
+    }
+    try {
+        return node.as<T>();
+    }
+    catch (const YAML::Exception&) {
+        return fallback;
+    }
+}
+
+/*
+ * Names of `Utils::ThreadPriority` in the yml file, in the order of its values.
+ */
+constexpr const char* priorityNames[] = { "background", "normal", "high" };
+
+/**
+ * @brief Gets the name of a scheduling priority as written in the yml file.
+ *
+ * @param priority Priority to name.
+ * @return const char*
+ */
+const char* priorityName(Utils::ThreadPriority priority) {
+    return priorityNames[(size_t)priority];
+}
+
+/**
+ * @brief Looks up a scheduling priority by the name written in the yml file.
+ *
+ * @param name Name of the priority.
+ * @param fallback Priority returned if `name` is not one of `priorityNames`.
+ * @return Utils::ThreadPriority
+ */
+Utils::ThreadPriority priorityFromName(const std::string& name, Utils::ThreadPriority fallback) {
+    for (size_t i = 0; i < std::size(priorityNames); i++) {
+        if (name == priorityNames[i]) {
+            return (Utils::ThreadPriority)i;
+        }
+    }
+    return fallback;
+}
+
+/**
+ * @brief Parses the yml file into `cfg`.
+ *
+ * @details
+ * Every key missing from the file keeps the value it already has in `cfg`, pass a copy of
+ * `ymlDefaults` to get a complete configuration.
+ *
+ * @param cfg Configuration to fill in.
+ * @param error Receives why the file could not be parsed.
+ * @return `true` if the file was parsed, `false` if `cfg` was left as is.
+ */
+bool parseYml(yml_t& cfg, std::string& error) {
+    YAML::Node config;
+    try {
+        config.reset(YAML::LoadFile(dllFile(YML_NAME)));
+    }
+    catch (const YAML::Exception& e) {
+        error = e.what();
+        return false;
+    }
+
+    cfg.name = ymlValue(config, { "name" }, cfg.name);
+
+    cfg.masterEnable = ymlValue(config, { "masterEnable" }, cfg.masterEnable);
+
+    cfg.resolution.width = ymlValue(config, { "resolution", "width" }, cfg.resolution.width);
+    cfg.resolution.height = ymlValue(config, { "resolution", "height" }, cfg.resolution.height);
+
+    cfg.fix.fov.enable = ymlValue(config, { "fixes", "fov", "enable" }, cfg.fix.fov.enable);
+    cfg.fix.fov.value = ymlValue(config, { "fixes", "fov", "value" }, cfg.fix.fov.value);
+
+    cfg.feature.scaleSprintFov.enable = ymlValue(config, { "features", "scaleSprintFov", "enable" }, cfg.feature.scaleSprintFov.enable);
+    cfg.feature.scaleSprintFov.value = ymlValue(config, { "features", "scaleSprintFov", "value" }, cfg.feature.scaleSprintFov.value);
+    cfg.feature.frameLimiter.enable = ymlValue(config, { "features", "frameLimiter", "enable" }, cfg.feature.frameLimiter.enable);
+    cfg.feature.frameLimiter.fps = ymlValue(config, { "features", "frameLimiter", "fps" }, cfg.feature.frameLimiter.fps);
+
+    cfg.advanced.scanner.threads = ymlValue(config, { "advanced", "scanner", "threads" }, cfg.advanced.scanner.threads);
+    cfg.advanced.scanner.cache = ymlValue(config, { "advanced", "scanner", "cache" }, cfg.advanced.scanner.cache);
+    auto priority = ymlValue(config, { "advanced", "scheduling", "priority" }, std::string(priorityName(cfg.advanced.scheduling.priority)));
+    cfg.advanced.scheduling.priority = priorityFromName(priority, cfg.advanced.scheduling.priority);
+    cfg.advanced.scheduling.efficiencyCores = ymlValue(config, { "advanced", "scheduling", "efficiencyCores" }, cfg.advanced.scheduling.efficiencyCores);
+    cfg.advanced.scheduling.yield = ymlValue(config, { "advanced", "scheduling", "yield" }, cfg.advanced.scheduling.yield);
+    cfg.advanced.startup.timeout = ymlValue(config, { "advanced", "startup", "timeout" }, cfg.advanced.startup.timeout);
+    cfg.advanced.logging.async = ymlValue(config, { "advanced", "logging", "async" }, cfg.advanced.logging.async);
+    cfg.advanced.logging.level = ymlValue(config, { "advanced", "logging", "level" }, cfg.advanced.logging.level);
+    cfg.advanced.reload.enable = ymlValue(config, { "advanced", "reload", "enable" }, cfg.advanced.reload.enable);
+    cfg.advanced.stats.enable = ymlValue(config, { "advanced", "stats", "enable" }, cfg.advanced.stats.enable);
+    cfg.advanced.stats.interval = ymlValue(config, { "advanced", "stats", "interval" }, cfg.advanced.stats.interval);
+    cfg.advanced.frameTimes.enable = ymlValue(config, { "advanced", "frameTimes", "enable" }, cfg.advanced.frameTimes.enable);
+    cfg.advanced.hooks.directPatch = ymlValue(config, { "advanced", "hooks", "directPatch" }, cfg.advanced.hooks.directPatch);
+    cfg.advanced.timing.json = ymlValue(config, { "advanced", "timing", "json" }, cfg.advanced.timing.json);
+    cfg.advanced.telemetry.enable = ymlValue(config, { "advanced", "telemetry", "enable" }, cfg.advanced.telemetry.enable);
+    return true;
+}
+
+/**
+ * @brief Replaces values in `cfg` that can't be used with their defaults.
  *
+ * @param cfg Configuration to validate.
  * @return void
  */
-void readYml() {
-    yml.name = config["name"].as<std::string>();
+void validateYml(yml_t& cfg) {
+    if (cfg.resolution.width < 0 || cfg.resolution.height < 0) {
+        cfg.resolution.width = ymlDefaults.resolution.width;
+        cfg.resolution.height = ymlDefaults.resolution.height;
+    }
+    if (!(cfg.feature.frameLimiter.fps > 0.0f)) {
+        cfg.feature.frameLimiter.fps = ymlDefaults.feature.frameLimiter.fps;
+    }
+    if (cfg.advanced.scanner.threads < 0) {
+        cfg.advanced.scanner.threads = ymlDefaults.advanced.scanner.threads;
+    }
+    if (cfg.advanced.startup.timeout < 0) {
+        cfg.advanced.startup.timeout = ymlDefaults.advanced.startup.timeout;
+    }
+    if (cfg.advanced.stats.interval <= 0) {
+        cfg.advanced.stats.interval = ymlDefaults.advanced.stats.interval;
+    }
+    if (spdlog::level::from_str(cfg.advanced.logging.level) == spdlog::level::off && cfg.advanced.logging.level != "off") {
+        cfg.advanced.logging.level = ymlDefaults.advanced.logging.level;
+    }
+}
+
+/**
+ * @brief Gets the modification time and size of the yml file, which key YML_CACHE_NAME.
+ *
+ * @param writeTime Receives the last write time of the yml file.
+ * @param size Receives the size of the yml file.
+ * @return `true` if the yml file exists.
+ */
+bool ymlStamp(uint64_t& writeTime, uint64_t& size) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(dllFile(YML_NAME).c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+    writeTime = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+    size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    return true;
+}
+
+/**
+ * @brief Loads `cfg` from YML_CACHE_NAME if it was written for the current yml file.
+ *
+ * @param cfg Configuration to fill in, only modified if the cache is valid.
+ * @param writeTime Last write time of the yml file.
+ * @param size Size of the yml file.
+ * @return `true` if `cfg` was loaded from the cache.
+ */
+bool loadYmlCache(yml_t& cfg, uint64_t writeTime, uint64_t size) {
+    yml_cache_t cache;
+    std::ifstream file(dllFile(YML_CACHE_NAME), std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&cache), sizeof(cache)) || file.peek() != std::ifstream::traits_type::eof()) {
+        return false;
+    }
+    if (cache.magic != ymlCacheMagic || cache.version != ymlCacheVersion || cache.writeTime != writeTime || cache.size != size) {
+        return false;
+    }
+    if (!memchr(cache.name, '\0', sizeof(cache.name)) || !memchr(cache.loggingLevel, '\0', sizeof(cache.loggingLevel))) {
+        return false;
+    }
+    if ((size_t)cache.scheduling.priority >= std::size(priorityNames)) {
+        return false;
+    }
 
-    yml.masterEnable = config["masterEnable"].as<bool>();
+    cfg.name = cache.name;
+    cfg.masterEnable = cache.masterEnable;
+    cfg.resolution = cache.resolution;
+    cfg.fix = cache.fix;
+    cfg.feature = cache.feature;
+    cfg.advanced.scanner = cache.scanner;
+    cfg.advanced.scheduling = cache.scheduling;
+    cfg.advanced.startup = cache.startup;
+    cfg.advanced.logging.async = cache.loggingAsync;
+    cfg.advanced.logging.level = cache.loggingLevel;
+    cfg.advanced.reload = cache.reload;
+    cfg.advanced.stats = cache.stats;
+    cfg.advanced.frameTimes = cache.frameTimes;
+    cfg.advanced.hooks = cache.hooks;
+    cfg.advanced.timing = cache.timing;
+    cfg.advanced.telemetry = cache.telemetry;
+    return true;
+}
 
-    yml.resolution.width = config["resolution"]["width"].as<int>();
-    yml.resolution.height = config["resolution"]["height"].as<int>();
+/**
+ * @brief Writes the validated `cfg` to YML_CACHE_NAME.
+ *
+ * @details
+ * A configuration whose strings don't fit the fixed size fields of `yml_cache_t` is not
+ * cached, it is parsed from the yml file on every launch instead.
+ *
+ * @param cfg Configuration parsed from the yml file.
+ * @param writeTime Last write time of the yml file.
+ * @param size Size of the yml file.
+ * @return `true` if the cache was written.
+ */
+bool saveYmlCache(const yml_t& cfg, uint64_t writeTime, uint64_t size) {
+    yml_cache_t cache = {};
+    if (cfg.name.size() >= sizeof(cache.name) || cfg.advanced.logging.level.size() >= sizeof(cache.loggingLevel)) {
+        return false;
+    }
+
+    cache.magic = ymlCacheMagic;
+    cache.version = ymlCacheVersion;
+    cache.writeTime = writeTime;
+    cache.size = size;
+    memcpy(cache.name, cfg.name.c_str(), cfg.name.size());
+    cache.masterEnable = cfg.masterEnable;
+    cache.resolution = cfg.resolution;
+    cache.fix = cfg.fix;
+    cache.feature = cfg.feature;
+    cache.scanner = cfg.advanced.scanner;
+    cache.scheduling = cfg.advanced.scheduling;
+    cache.startup = cfg.advanced.startup;
+    cache.loggingAsync = cfg.advanced.logging.async;
+    memcpy(cache.loggingLevel, cfg.advanced.logging.level.c_str(), cfg.advanced.logging.level.size());
+    cache.reload = cfg.advanced.reload;
+    cache.stats = cfg.advanced.stats;
+    cache.frameTimes = cfg.advanced.frameTimes;
+    cache.hooks = cfg.advanced.hooks;
+    cache.timing = cfg.advanced.timing;
+    cache.telemetry = cfg.advanced.telemetry;
+
+    std::ofstream file(dllFile(YML_CACHE_NAME), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&cache), sizeof(cache));
+    return file.good();
+}
 
-    yml.fix.fov.enable = config["fixes"]["fov"]["enable"].as<bool>();
-    yml.fix.fov.value = config["fixes"]["fov"]["value"].as<float>();
+/**
+ * @brief Reads the configuration settings into the `yml` structure.
+ *
+ * This function performs the following tasks:
+ * 1. Loads the configuration from YML_CACHE_NAME if it is up to date with the yml file.
+ * 2. Otherwise parses the yml file, validates it and writes it to YML_CACHE_NAME.
+ * 3. Initializes global settings if certain values are missing or default.
+ *
+ * @details
+ * This runs on the thread created by `DllMain()`, not while the DLL is loaded. Reading the
+ * yml file during static initialization held the loader lock for the duration of the file
+ * I/O and parsing, which stalled every other module the game loaded in the meantime.
+ *
+ * Keys missing from the yml file and values of the wrong type fall back to `ymlDefaults`,
+ * as do all settings if the yml file can't be parsed at all. Nothing is logged here, as the
+ * logging options are part of the configuration, see `logYml()`.
+ *
+ * @return void
+ */
+void readYml() {
+    Timing::Phase phase(__func__);
+    uint64_t writeTime = 0;
+    uint64_t size = 0;
+    bool stamped = ymlStamp(writeTime, size);
 
-    yml.feature.scaleSprintFov.enable = config["features"]["scaleSprintFov"]["enable"].as<bool>();
-    yml.feature.scaleSprintFov.value = config["features"]["scaleSprintFov"]["value"].as<float>();
+    yml = ymlDefaults;
+    if (stamped && loadYmlCache(yml, writeTime, size)) {
+        ymlSource = "Loaded " YML_CACHE_NAME;
+    }
+    else {
+        std::string error;
+        if (parseYml(yml, error)) {
+            validateYml(yml);
+            ymlSource = "Parsed " YML_NAME;
+            if (stamped && !saveYmlCache(yml, writeTime, size)) {
+                ymlSource += ", failed to write " YML_CACHE_NAME;
+            }
+        }
+        else {
+            ymlSource = std::format("Failed to parse {}, using defaults: {}", YML_NAME, error);
+        }
+    }
 
     // Initialize globals
     if (yml.resolution.width == 0 || yml.resolution.height == 0) {
@@ -156,7 +705,15 @@ void readYml() {
         yml.resolution.height = dimensions.second;
     }
     yml.resolution.aspectRatio = (float)yml.resolution.width / (float)yml.resolution.height;
+}
 
+/**
+ * @brief Logs the configuration read by `readYml()`.
+ *
+ * @return void
+ */
+void logYml() {
+    LOG("{}", ymlSource);
     LOG("Name: {}", yml.name);
     LOG("MasterEnable: {}", yml.masterEnable);
     LOG("Resolution.Width: {}", yml.resolution.width);
@@ -164,8 +721,509 @@ void readYml() {
     LOG("Resolution.AspectRatio: {}", yml.resolution.aspectRatio);
     LOG("Fix.Fov.Enable: {}", yml.fix.fov.enable);
     LOG("Fix.Fov.Value: {}", yml.fix.fov.value);
-    LOG("Fix.Fov.Enable: {}", yml.feature.scaleSprintFov.enable);
-    LOG("Fix.Fov.Value: {}", yml.feature.scaleSprintFov.value);
+    LOG("Feature.ScaleSprintFov.Enable: {}", yml.feature.scaleSprintFov.enable);
+    LOG("Feature.ScaleSprintFov.Value: {}", yml.feature.scaleSprintFov.value);
+    LOG("Feature.FrameLimiter.Enable: {}", yml.feature.frameLimiter.enable);
+    LOG("Feature.FrameLimiter.Fps: {}", yml.feature.frameLimiter.fps);
+    LOG("Advanced.Scanner.Threads: {}", yml.advanced.scanner.threads);
+    LOG("Advanced.Scanner.Cache: {}", yml.advanced.scanner.cache);
+    LOG("Advanced.Scheduling.Priority: {}", priorityName(yml.advanced.scheduling.priority));
+    LOG("Advanced.Scheduling.EfficiencyCores: {}", yml.advanced.scheduling.efficiencyCores);
+    LOG("Advanced.Scheduling.Yield: {}", yml.advanced.scheduling.yield);
+    LOG("Advanced.Startup.Timeout: {}", yml.advanced.startup.timeout);
+    LOG("Advanced.Logging.Async: {}", yml.advanced.logging.async);
+    LOG("Advanced.Logging.Level: {}", yml.advanced.logging.level);
+    LOG("Advanced.Reload.Enable: {}", yml.advanced.reload.enable);
+    LOG("Advanced.Stats.Enable: {}", yml.advanced.stats.enable);
+    LOG("Advanced.Stats.Interval: {}", yml.advanced.stats.interval);
+    LOG("Advanced.FrameTimes.Enable: {}", yml.advanced.frameTimes.enable);
+    LOG("Advanced.Hooks.DirectPatch: {}", yml.advanced.hooks.directPatch);
+    LOG("Advanced.Timing.Json: {}", yml.advanced.timing.json);
+    LOG("Advanced.Telemetry.Enable: {}", yml.advanced.telemetry.enable);
+}
+
+/**
+ * @brief Applies the scheduling policy from the configuration to the thread running `Main()`.
+ *
+ * @details
+ * While the fix starts up the game is loading as well, on as many threads as it can. By
+ * default startup runs at normal priority rather than above the game's own threads, the
+ * scan and the hooks are finished long before the first frame either way. The policy is
+ * also used by the threads of the signature scan, see `Utils::setScheduling()`.
+ *
+ * @return void
+ */
+void applyScheduling() {
+    const scheduling_t& policy = yml.advanced.scheduling;
+    if (!Utils::setScheduling({ policy.priority, policy.efficiencyCores, policy.yield })) {
+        LOG("Failed to apply the scheduling policy, startup may run on any core or at another priority");
+    }
+}
+
+/**
+ * @brief Computes the factor the master FOV controller hook scales the game's FOV by.
+ *
+ * @details
+ * The configured FOV is for a 16:9 screen, the horizontal FOV that gives the same vertical
+ * FOV at the configured aspect ratio is:
+ *      newFov = atan(tan(fov / 2) / nativeAspectRatio * aspectRatio) * 2
+ * The game's FOV changes with zooming and sprinting, so rather than setting it to `newFov`
+ * it is scaled by `newFov / inGameSetFov`. This only changes with the config, so it is
+ * computed when a hot state is published and the hook only has to multiply by it.
+ *
+ * @param cfg Config to compute the factor for
+ * @return float
+ */
+float computeFovScale(const yml_t& cfg) {
+    float pi = std::numbers::pi_v<float>;
+    float newFov = atanf((tanf(cfg.fix.fov.value * pi / 360.0f) / nativeAspectRatio) * cfg.resolution.aspectRatio) * 360.0f / pi;
+    return newFov / inGameSetFov;
+}
+
+/**
+ * @brief Publishes the values the hooks read for a config.
+ *
+ * @details
+ * Builds a new `hot_state_t` from `cfg` and swaps it into `hotState`. A disabled fix or
+ * feature gets a factor of 1, so a hook that is already installed leaves the game's values
+ * alone when it is disabled by a reload. Must only be called from one thread at a time.
+ *
+ * @param cfg Config to publish
+ * @return void
+ */
+void publishHotState(const yml_t& cfg) {
+    auto next = std::make_unique<hot_state_t>();
+    next->fovScale = cfg.fix.fov.enable ? computeFovScale(cfg) : 1.0f;
+    next->sprintFovScale = cfg.feature.scaleSprintFov.enable ? cfg.feature.scaleSprintFov.value : 1.0f;
+    next->inGameSetFov = inGameSetFov;
+    next->width = (uint32_t)cfg.resolution.width;
+    next->height = (uint32_t)cfg.resolution.height;
+    next->aspectClamp = (uint32_t)cfg.resolution.height + 0x1;
+    hotState.store(next.get(), std::memory_order_release);
+    hotStates.push_back(std::move(next));
+}
+
+/**
+ * @brief Re-reads the yml file and publishes the values that can change while the game runs.
+ *
+ * @details
+ * Only the FOV and sprint FOV values and their enables are reloaded. Everything else is used
+ * once at startup and needs a restart of the game. Enabling a fix or feature that was disabled
+ * at startup has no effect, as its hook was never installed. If the yml file can not be parsed,
+ * for example because it is being saved, the current values are kept.
+ *
+ * @return void
+ */
+void reloadYml() {
+    yml_t next = yml;
+    try {
+        YAML::Node node;
+        node.reset(YAML::LoadFile(dllFile(YML_NAME)));
+        next.fix.fov.enable = ymlValue(node, { "fixes", "fov", "enable" }, next.fix.fov.enable);
+        next.fix.fov.value = ymlValue(node, { "fixes", "fov", "value" }, next.fix.fov.value);
+        next.feature.scaleSprintFov.enable = ymlValue(node, { "features", "scaleSprintFov", "enable" }, next.feature.scaleSprintFov.enable);
+        next.feature.scaleSprintFov.value = ymlValue(node, { "features", "scaleSprintFov", "value" }, next.feature.scaleSprintFov.value);
+    }
+    catch (const YAML::Exception& e) {
+        LOG("Failed to reload {}: {}", YML_NAME, e.what());
+        return;
+    }
+
+    publishHotState(next);
+    LOG("Fix.Fov.Enable: {}", next.fix.fov.enable);
+    LOG("Fix.Fov.Value: {}", next.fix.fov.value);
+    LOG("Feature.ScaleSprintFov.Enable: {}", next.feature.scaleSprintFov.enable);
+    LOG("Feature.ScaleSprintFov.Value: {}", next.feature.scaleSprintFov.value);
+}
+
+/**
+ * @brief Watches the yml file and reloads it whenever it is written.
+ *
+ * @details
+ * Runs on its own thread for as long as the game runs. ReadDirectoryChangesW blocks until
+ * something in the game's working directory changes, so the thread does nothing until the
+ * yml file is saved. Editors tend to write a file more than once when saving, so the reload
+ * waits a moment for the writes to settle first.
+ *
+ * @param lpParameter Unused
+ * @return DWORD
+ */
+DWORD __stdcall ymlWatcher(void* lpParameter) {
+    std::wstring folder = dllDirectory.empty() ? L"." : dllDirectory.wstring();
+    HANDLE directory = CreateFileW(folder.c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL
+    );
+    if (directory == INVALID_HANDLE_VALUE) {
+        LOG("Failed to watch {}, reloading is disabled", YML_NAME);
+        return false;
+    }
+
+    alignas(DWORD) uint8_t buffer[4096];
+    DWORD size;
+    std::wstring_view ymlName = L"" YML_NAME;
+    while (ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE,
+        FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME, &size, NULL, NULL)
+    ) {
+        // A size of 0 means there were too many changes to report, assume the yml was one of them
+        bool changed = size == 0;
+        for (DWORD offset = 0; size != 0;) {
+            auto info = reinterpret_cast<FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            std::wstring_view name(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            changed |= name == ymlName;
+            if (info->NextEntryOffset == 0) {
+                break;
+            }
+            offset += info->NextEntryOffset;
+        }
+        if (changed) {
+            Sleep(100);
+            reloadYml();
+        }
+    }
+
+    CloseHandle(directory);
+    return true;
+}
+
+/**
+ * @brief Loads the signature cache, if enabled.
+ *
+ * @details
+ * The cache holds the RVA of every signature and of the resolution slots, keyed by the
+ * identity of the game's executable, see `Cache::load()`. It is loaded before anything looks
+ * up an address, and written back by `scanSignatures()` once all addresses were resolved.
+ *
+ * @return void
+ */
+void loadCache() {
+    if (!yml.masterEnable || !yml.advanced.scanner.cache) {
+        return;
+    }
+    Timing::Phase phase("cache");
+    bool valid = Cache::load(baseModule, dllFile(cacheName).c_str());
+    LOG("Signature cache {}", valid ? "matches executable" : "is missing or outdated");
+}
+
+/**
+ * @brief Gets the address of the first resolution slot, from the cache if it is there.
+ *
+ * @return Address of the first resolution slot, not verified.
+ */
+uintptr_t resolutionSlot() {
+    auto cached = yml.advanced.scanner.cache ? Cache::findAddress(resSlotCacheName) : std::nullopt;
+    return cached ? *cached : (uintptr_t)baseModule + resSlotRva;
+}
+
+/**
+ * @brief Checks if `first` is the first of the resolution slots.
+ *
+ * @details
+ * It is if it holds a plausible width and height, and every other slot in `resSlotLayout`
+ * holds the same width and height. No other data in the game's module follows that layout.
+ *
+ * @param first Address to check.
+ * @return `true` if the resolution slots start at `first`.
+ */
+bool isResolutionSlot(uintptr_t first) {
+    auto dosHeader = (PIMAGE_DOS_HEADER)baseModule;
+    auto ntHeaders = (PIMAGE_NT_HEADERS)((uint8_t*)baseModule + dosHeader->e_lfanew);
+    uintptr_t begin = (uintptr_t)baseModule;
+    uintptr_t end = begin + ntHeaders->OptionalHeader.SizeOfImage;
+    if (first < begin || first + resSlotLayout[std::size(resSlotLayout) - 1] + 2 * sizeof(int) > end) {
+        return false;
+    }
+
+    int resolution[2];
+    memcpy(resolution, (const void*)first, sizeof(resolution));
+    if (resolution[0] <= 0 || resolution[0] > 16384 || resolution[1] <= 0 || resolution[1] > 16384) {
+        return false;
+    }
+    for (uintptr_t offset : resSlotLayout) {
+        if (memcmp((const void*)(first + offset), resolution, sizeof(resolution)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * The launcher saves the chosen resolution as ResX and ResY in the [SystemSettings] section of
+ * the game's engine ini, under Documents. The folder name differs between releases.
+ */
+const wchar_t* launcherIniPaths[] = {
+    L"\\My Games\\Borderlands Game of the Year Enhanced\\WillowGame\\Config\\WillowEngine.ini",
+    L"\\My Games\\Borderlands Game of the Year\\WillowGame\\Config\\WillowEngine.ini",
+};
+
+/*
+ * Slots found by `resolutionFix()`, patched by `patchResolutionSlots()` once the hooks are in.
+ */
+std::vector<uintptr_t> resolutionSlots;
+
+/**
+ * @brief Reads the resolution last chosen in the game's launcher.
+ *
+ * @return Width and height, 0x0 if no engine ini holds a resolution.
+ */
+std::pair<int, int> launcherResolution() {
+    PWSTR documents = nullptr;
+    if (FAILED(SHGetKnownFolderPath(FOLDERID_Documents, 0, nullptr, &documents))) {
+        CoTaskMemFree(documents);
+        return {};
+    }
+    std::wstring folder = documents;
+    CoTaskMemFree(documents);
+    for (const wchar_t* ini : launcherIniPaths) {
+        std::wstring path = folder + ini;
+        int width = (int)GetPrivateProfileIntW(L"SystemSettings", L"ResX", 0, path.c_str());
+        int height = (int)GetPrivateProfileIntW(L"SystemSettings", L"ResY", 0, path.c_str());
+        if (width > 0 && height > 0) {
+            return { width, height };
+        }
+    }
+    return {};
+}
+
+/**
+ * @brief Finds the slots the game keeps the resolution chosen in the launcher in.
+ *
+ * This function performs the following tasks:
+ * 1. Checks the cached, or otherwise the known, address of the first slot.
+ * 2. If the slots are not there, scans the game's writable sections for the launcher's, the
+ *      desktop and the configured resolution, and checks every match.
+ * 3. Stores the first slot in the signature cache, if enabled.
+ *
+ * @details
+ * The slots used to be patched at fixed RVAs, which break with any update to the game. By the
+ * time this runs the game has written the resolution from the launcher to every slot, see
+ * `waitForGame()`, so the slots can be found by their value. The resolution the launcher saved
+ * in the engine ini is tried first, see `launcherResolution()`, then the desktop resolution
+ * the launcher defaults to. A match only counts if every other slot in `resSlotLayout` holds
+ * the same resolution, see `isResolutionSlot()`.
+ *
+ * @return Address of every slot, empty if they were not found.
+ */
+std::vector<uintptr_t> findResolutionSlots() {
+    Timing::Phase phase(__func__);
+    uintptr_t first = resolutionSlot();
+    if (!isResolutionSlot(first)) {
+        first = 0;
+        std::pair<int, int> candidates[] = {
+            launcherResolution(),
+            Utils::GetDesktopDimensions(),
+            { yml.resolution.width, yml.resolution.height },
+        };
+        for (size_t i = 0; i < std::size(candidates) && !first; i++) {
+            auto [width, height] = candidates[i];
+            if (width <= 0 || height <= 0 || std::find(candidates, candidates + i, candidates[i]) != candidates + i) {
+                continue;
+            }
+            uint64_t matches[64];
+            size_t count = Utils::pairScan(baseModule, (uint32_t)width, (uint32_t)height, matches, std::size(matches));
+            LOG("Found {} matches of {}x{} in writable sections", count, width, height);
+            for (size_t j = 0; j < count && !first; j++) {
+                if (isResolutionSlot((uintptr_t)matches[j])) {
+                    first = (uintptr_t)matches[j];
+                }
+            }
+        }
+        if (!first) {
+            return {};
+        }
+    }
+    if (yml.advanced.scanner.cache) {
+        Cache::storeAddress(resSlotCacheName, first);
+    }
+
+    std::vector<uintptr_t> slots;
+    for (uintptr_t offset : resSlotLayout) {
+        slots.push_back(first + offset);
+    }
+    return slots;
+}
+
+/**
+ * @brief Waits until the game is ready for the fixes to be applied.
+ *
+ * This function performs the following tasks:
+ * 1. Polls the resolution slots the game keeps in its .data section with `isResolutionSlot()`.
+ * 2. Returns once every slot holds the same plausible resolution and has stopped changing, or
+ *      once the configured timeout elapsed.
+ *
+ * @details
+ * The fixes used to be applied after a fixed 5 second sleep, as the game writes the resolution
+ * chosen in the launcher over the patched resolution while it loads, see `resolutionFix()`.
+ * That was too long on fast machines and sometimes too short on slow ones. Instead the slots
+ * starting at BorderlandsGOTY.exe+25E50A0, unless the cache knows better, are polled, and as
+ * soon as the game has written the width and height there it is safe to patch them. The slots
+ * are only read, guarding the page instead would make the calls the game makes with buffers on
+ * it fail. If the slots never hold a resolution before the timeout elapses the fixes are
+ * applied anyway, which is the same behavior as the fixed sleep had, with the same 5 second
+ * default.
+ *
+ * @return void
+ */
+void waitForGame() {
+    Timing::Phase phase(__func__);
+    uintptr_t resAddr = resolutionSlot();
+    int timeout = std::max(yml.advanced.startup.timeout, 0);
+    bool ready = Utils::waitForWrite(resAddr, 2 * sizeof(int), isResolutionSlot, timeout);
+    if (ready) {
+        LOG("Game wrote resolution @ 0x{:x}", resAddr - (uintptr_t)baseModule);
+    }
+    else {
+        LOG("Timed out after {}ms waiting for game to write resolution", timeout);
+    }
+}
+
+/**
+ * @brief Resolves all signatures in a single scan of the game's module.
+ *
+ * This function performs the following tasks:
+ * 1. Looks up the signature of every enabled fix in `fixRegistry` in the signature cache,
+ *      if enabled, see `loadCache()`.
+ * 2. Sets the number of scanner threads from the configuration.
+ * 3. Scans the base module once for every signature that was not found in the cache.
+ * 4. Stores the first address found for each signature in `signatureHits`.
+ * 5. Writes newly found signatures and resolution slots back to the signature cache.
+ *
+ * Only the first match of each signature is used, so the scan stops as soon as every
+ * signature has been found once. A signature that was not found has no entry in its
+ * `signatureHits` vector.
+ *
+ * The cache file sits next to the log and maps each signature to the RVA it was found at,
+ * keyed by the identity of the game's executable. As the executable rarely changes between
+ * launches, usually every signature is served from the cache after verifying its bytes at the
+ * cached RVA, and no scan has to run at all.
+ *
+ * Signatures that no enabled fix uses are not resolved at all, and when `masterEnable` is
+ * `false` the scan is skipped altogether, as no fix will be applied.
+ *
+ * @return void
+ */
+void scanSignatures() {
+    signatureHits.assign(signatures.size(), {});
+    std::vector<bool> needed(signatures.size(), false);
+    size_t neededCount = 0;
+    for (const fix_desc_t& fix : fixRegistry) {
+        if (fix.enabled(yml) && !needed[fix.signature]) {
+            needed[fix.signature] = true;
+            neededCount++;
+        }
+    }
+    if (neededCount == 0) {
+        return;
+    }
+
+    std::vector<Utils::SignatureView> misses;
+    std::vector<size_t> missIndex;
+    {
+        Timing::Phase phase("cache");
+        for (size_t i = 0; i < signatures.size(); i++) {
+            if (!needed[i]) {
+                continue;
+            }
+            auto address = yml.advanced.scanner.cache ? Cache::find(signatures[i]) : std::nullopt;
+            if (address) {
+                signatureHits[i].push_back(*address);
+            }
+            else {
+                misses.push_back(signatures[i]);
+                missIndex.push_back(i);
+            }
+        }
+    }
+    LOG("Signatures: {} cached, {} to scan", neededCount - misses.size(), misses.size());
+
+    if (!misses.empty()) {
+        std::vector<std::vector<uint64_t>> hits;
+        Utils::setScanThreads(std::max(yml.advanced.scanner.threads, 0));
+        {
+            Timing::Phase phase("patternScan");
+            Utils::patternScan(baseModule, misses, &hits, 1);
+        }
+        for (size_t i = 0; i < misses.size(); i++) {
+            signatureHits[missIndex[i]] = hits[i];
+            if (yml.advanced.scanner.cache && !hits[i].empty()) {
+                Cache::store(misses[i], hits[i][0]);
+            }
+        }
+    }
+    Timing::Phase phase("cacheSave");
+    if (yml.advanced.scanner.cache && !Cache::save(dllFile(cacheName).c_str())) {
+        LOG("Failed to write signature cache");
+    }
+}
+
+/**
+ * @brief Installs the hooks of every enabled fix and feature in `fixRegistry`.
+ *
+ * This function performs the following tasks:
+ * 1. Checks if each fix is enabled based on the configuration.
+ * 2. Takes the address its signature was found at from `signatureHits`.
+ * 3. Adds its hook to `hooks`, or a direct patch for MovEax fixes if enabled.
+ * 4. Commits the batch, which enables the mid hooks one by one and applies the direct patches
+ *      in a single freeze.
+ *
+ * @details
+ * A MovEax fix only sets eax to a constant. With `advanced.hooks.directPatch` it is applied as
+ * a `mov eax, value` code patch instead of a mid hook, see `Hooks::Batch::addMovEax()`, which
+ * spares saving and restoring the whole context every time the hook site runs. Where the code
+ * can not be patched directly its mid hook is used regardless.
+ *
+ * @return void
+ */
+void applyFixes() {
+    for (const fix_desc_t& fix : fixRegistry) {
+        const char* patternFind = signatures[fix.signature].string;
+
+        bool enable = fix.enabled(yml);
+        LOG("{} {}", fix.name, enable ? "Enabled" : "Disabled");
+        if (enable) {
+            std::vector<uint64_t>& addr = signatureHits[fix.signature];
+            uint8_t* hit = addr.empty() ? nullptr : (uint8_t*)addr[0];
+            uintptr_t absAddr = (uintptr_t)hit;
+            uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
+            if (hit) {
+                LOG("Found '{}' @ 0x{:x}", patternFind, relAddr);
+                const char* problem;
+                void* target = Hooks::resolveSite(hit, fix.site, &problem);
+                if (!target) {
+                    WARN("Did not find a safe hook site after 0x{:x}, {}", relAddr, problem);
+                    continue;
+                }
+                if (problem) {
+                    WARN("Hooking 0x{:x} anyway, {}", (uintptr_t)target - (uintptr_t)baseModule, problem);
+                }
+                uintptr_t hookOffset = (uintptr_t)target - absAddr;
+                uintptr_t hookRelAddr = relAddr + hookOffset;
+                bool patched = false;
+                bool hooked = false;
+                {
+                    Timing::Phase phase("createMid");
+                    patched = fix.kind == MovEax && yml.advanced.hooks.directPatch && hooks.addMovEax(target, fix.value);
+                    hooked = !patched && hooks.add(target, fix.callback);
+                }
+                if (patched) {
+                    LOG("Patched @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset, hookRelAddr);
+                }
+                else if (hooked) {
+                    LOG("Hooked @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset, hookRelAddr);
+                }
+                else {
+                    LOG("Failed to hook @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset, hookRelAddr);
+                }
+            }
+            else {
+                LOG("Did not find '{}'", patternFind);
+            }
+        }
+    }
+
+    Timing::Phase phase("commitHooks");
+    size_t pendingHooks = hooks.pending();
+    LOG("Enabled {} of {} hooks", hooks.commit(), pendingHooks);
 }
 
 /**
@@ -173,15 +1231,17 @@ void readYml() {
  *
  * This function performs the following tasks:
  * 1. Logs the current desktop resolution and aspect ratio.
- * 2. Places hooks at `patternFind0` and `patternFind1`.
- * 3. Patches two memory addresses at `resWidthAddrPatch` and `resHeightAddrPatch`.
+ * 2. Registers hooks at `patternFind0` and `patternFind1` in `fixRegistry`.
+ * 3. Finds the resolution slots with `findResolutionSlots()`, which `patchResolutionSlots()`
+ *      patches after the hooks are applied.
  *
  * @details
  * The function first logs the desktop resolution and aspect ratio for debugging purposes.
  * It places hooks at `patternFind0` and `patternFind1` where the RAX register shall be
  * overwritten with the target width and height parameters in the configuration file. And will
- * also patch two memory addresses at `resWidthAddrPatch` and `resHeightAddrPatch` also using the
- * target width and height parameters in the configuration file.
+ * also patch every slot the game keeps the launcher's resolution in, found by
+ * `findResolutionSlots()`, with the target width and height parameters in the configuration
+ * file. If the slots can't be found a warning is logged and only the hooks are applied.
  *
  * The hooking and patching is only performed if the `masterEnable` flag is set to `true`.
  *
@@ -209,6 +1269,12 @@ void readYml() {
  * The hooks where placed where the move instruction takes place and eax was overwritten with the
  * provided width and height parameters from the configuration file.
  *
+ * These hooks, and the one for `patternFind2`, only set eax to a constant. With
+ * `advanced.hooks.directPatch` they are applied as a `mov eax, value` code patch instead of a
+ * mid hook, see `Hooks::Batch::addMovEax()`, which spares saving and restoring the whole context
+ * every time the game queries the resolution. Where the code can not be patched directly a mid
+ * hook is used regardless.
+ *
  * Hooking for `patternFind2`:
  * Going beyond 21:9 is problematic as it introduces some artifacting to the left of the screen
  * which is a copy of what is on the right side of the screen. I can probably say this is some
@@ -234,22 +1300,6 @@ void readYml() {
  * @return void
  */
 void resolutionFix() {
-    const char* patternFind0  = "44 8B ?? 41 8D ?? ?? 48 8B ?? ?? ?? FF 15 ?? ?? ?? ??";
-    uintptr_t hookOffset0 = 0;
-    const char* patternFind1  = "FF 15 ?? ?? ?? ?? 44 8B ?? 45 8B ??";
-    uintptr_t hookOffset1 = 6;
-    const char* patternFind2  = "CC    8B 81 A0 00 00 00    C3    CC";
-    uintptr_t hookOffset2 = 7;
-    std::vector<uintptr_t> resAddrPatch  = {
-        (uintptr_t)baseModule + 0x25E50A0,
-        (uintptr_t)baseModule + 0x25E5730,
-        (uintptr_t)baseModule + 0x25E5C68,
-        (uintptr_t)baseModule + 0x25E61A0,
-        (uintptr_t)baseModule + 0x25E66D8,
-        (uintptr_t)baseModule + 0x25E6974,
-        (uintptr_t)baseModule + 0x25E6C10,
-    };
-
     LOG("Desktop resolution: {}x{}",
         yml.resolution.width, yml.resolution.height
     );
@@ -259,82 +1309,89 @@ void resolutionFix() {
         yml.resolution.aspectRatio
     );
 
-    bool enable = yml.masterEnable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind0, &addr);
-        uint8_t* hit = (uint8_t*)addr[0];
-        uintptr_t absAddr = (uintptr_t)hit;
-        uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-        if (hit) {
-            LOG("Found '{}' @ 0x{:x}", patternFind0, relAddr);
-            uintptr_t hookAbsAddr = absAddr + hookOffset0;
-            uintptr_t hookRelAddr = relAddr + hookOffset0;
-            static SafetyHookMid fovMidHook{};
-            fovMidHook = safetyhook::create_mid(reinterpret_cast<void*>(hookAbsAddr),
-                [](SafetyHookContext& ctx) {
-                    ctx.rax = yml.resolution.width;
-                }
-            );
-            LOG("Hooked @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset0, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind0);
-        }
-    }
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind1, &addr);
-        uint8_t* hit = (uint8_t*)addr[0];
-        uintptr_t absAddr = (uintptr_t)hit;
-        uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-        if (hit) {
-            LOG("Found '{}' @ 0x{:x}", patternFind1, relAddr);
-            uintptr_t hookAbsAddr = absAddr + hookOffset1;
-            uintptr_t hookRelAddr = relAddr + hookOffset1;
-            static SafetyHookMid fovMidHook{};
-            fovMidHook = safetyhook::create_mid(reinterpret_cast<void*>(hookAbsAddr),
-                [](SafetyHookContext& ctx) {
-                    ctx.rax = yml.resolution.height;
-                }
-            );
-            LOG("Hooked @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset1, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind1);
+    auto enabled = [](const yml_t& cfg) {
+        return cfg.masterEnable;
+    };
+    fixRegistry.push_back({
+        .name = "Resolution width",
+        .signature = ResWidth,
+        // mov r15d,eax
+        .site = { .mnemonic = ZYDIS_MNEMONIC_MOV, .source = ZYDIS_REGISTER_EAX },
+        .kind = MovEax,
+        .callback = [](SafetyHookContext& ctx) {
+            Stats::Scope scope(ResWidth);
+            Trace::HookScope trace(ResWidth, (float)(uint32_t)ctx.rax);
+            ctx.rax = hotState.load(std::memory_order_acquire)->width;
+            trace.setOutput((float)(uint32_t)ctx.rax);
+        },
+        .value = (uint32_t)yml.resolution.width,
+        .enabled = enabled,
+    });
+    fixRegistry.push_back({
+        .name = "Resolution height",
+        .signature = ResHeight,
+        // mov r12d,eax after the call to wtol
+        .site = { .mnemonic = ZYDIS_MNEMONIC_MOV, .source = ZYDIS_REGISTER_EAX, .after = ZYDIS_MNEMONIC_CALL },
+        .kind = MovEax,
+        .callback = [](SafetyHookContext& ctx) {
+            Stats::Scope scope(ResHeight);
+            Trace::HookScope trace(ResHeight, (float)(uint32_t)ctx.rax);
+            ctx.rax = hotState.load(std::memory_order_acquire)->height;
+            trace.setOutput((float)(uint32_t)ctx.rax);
+        },
+        .value = (uint32_t)yml.resolution.height,
+        .enabled = enabled,
+    });
+    fixRegistry.push_back({
+        .name = "Resolution aspect clamp",
+        .signature = ResAspectClamp,
+        .site = { .mnemonic = ZYDIS_MNEMONIC_RET },
+        .kind = MovEax,
+        .callback = [](SafetyHookContext& ctx) {
+            Stats::Scope scope(ResAspectClamp);
+            Trace::HookScope trace(ResAspectClamp, (float)(uint32_t)ctx.rax);
+            ctx.rax = hotState.load(std::memory_order_acquire)->aspectClamp;
+            trace.setOutput((float)(uint32_t)ctx.rax);
+        },
+        .value = (uint32_t)yml.resolution.height + 0x1,
+        .enabled = enabled,
+    });
+
+    if (yml.masterEnable) {
+        resolutionSlots = findResolutionSlots();
+        if (resolutionSlots.empty()) {
+            WARN("Did not find resolution slots, the resolution from the launcher will not be replaced");
         }
     }
-    if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind2, &addr);
-        uint8_t* hit = (uint8_t*)addr[0];
-        uintptr_t absAddr = (uintptr_t)hit;
-        uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-        if (hit) {
-            LOG("Found '{}' @ 0x{:x}", patternFind2, relAddr);
-            uintptr_t hookAbsAddr = absAddr + hookOffset2;
-            uintptr_t hookRelAddr = relAddr + hookOffset2;
-            static SafetyHookMid fovMidHook{};
-            fovMidHook = safetyhook::create_mid(reinterpret_cast<void*>(hookAbsAddr),
-                [](SafetyHookContext& ctx) {
-                    ctx.rax = yml.resolution.height + 0x1;
-                }
-            );
-            LOG("Hooked @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset2, hookRelAddr);
+}
+
+/**
+ * @brief Patches the resolution slots found by `resolutionFix()` with the target resolution.
+ *
+ * @details
+ * Runs after `applyFixes()`, so that the width and height hooks are already in place when the
+ * slots are written. Patched before the hooks, the game could still overwrite the slots with
+ * the launcher's resolution in between.
+ *
+ * @return void
+ */
+void patchResolutionSlots() {
+    if (!resolutionSlots.empty()) {
+        int resolution[2] = { yml.resolution.width, yml.resolution.height };
+        std::span<const uint8_t> resBytes(reinterpret_cast<const uint8_t*>(resolution), sizeof(resolution));
+        Utils::PatchBatch resBatch;
+        for (size_t i = 0; i < resolutionSlots.size(); i++) {
+            resBatch.add(resolutionSlots[i], resBytes);
         }
-        else {
-            LOG("Did not find '{}'", patternFind2);
+        size_t protects;
+        {
+            Timing::Phase phase("patch");
+            protects = resBatch.commit();
         }
-    }
-    if (enable) {
-        std::string widthString = Utils::bytesToString((void*)&yml.resolution.width, sizeof(yml.resolution.width));
-        std::string heightString = Utils::bytesToString((void*)&yml.resolution.height, sizeof(yml.resolution.height));
-        std::string resString = widthString + ' ' + heightString;
-        for (size_t i = 0; i < resAddrPatch.size(); i++) {
-            Utils::patch(resAddrPatch[i], resString.c_str());
-            LOG("Patched '{}' @ 0x{:x}", resString, resAddrPatch[i]);
+        for (size_t i = 0; i < resolutionSlots.size(); i++) {
+            LOG("Patched '{}' @ 0x{:x}", Utils::bytesToString(resolution, sizeof(resolution)), resolutionSlots[i]);
         }
+        LOG("Patched {} addresses with {} protection changes", resolutionSlots.size(), protects);
     }
 }
 
@@ -342,9 +1399,8 @@ void resolutionFix() {
  * @brief Applies a field of view (FOV) fix by hooking a specific pattern in memory.
  *
  * This function performs the following tasks:
- * 1. Checks if the FOV fix is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks the identified pattern to modify the FOV value.
+ * 1. Registers a hook in `fixRegistry` that modifies the FOV value, applied by `applyFixes()`
+ *      if the FOV fix is enabled based on the configuration.
  *
  * @details
  * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
@@ -392,45 +1448,30 @@ void resolutionFix() {
  * @return void
  */
 void fovFix() {
-    const char* patternFind  = "F3 0F 11 ?? ?? ?? ?? ?? 8B ?? ?? ?? ?? ?? 89 ?? ?? ?? ?? ?? 48 83 ?? ?? 5B C3";
-    uintptr_t hookOffset = 0;
-
-    bool enable = yml.masterEnable & yml.fix.fov.enable;
-    LOG("Fix {}", enable ? "Enabled" : "Disabled");
-    if (enable) { // Master FOV controller
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        uint8_t* hit = (uint8_t*)addr[0];
-        uintptr_t absAddr = (uintptr_t)hit;
-        uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-        if (hit) {
-            LOG("Found '{}' @ 0x{:x}", patternFind, relAddr);
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            static SafetyHookMid fovMidHook{};
-            fovMidHook = safetyhook::create_mid(reinterpret_cast<void*>(hookAbsAddr),
-                [](SafetyHookContext& ctx) {
-                    float pi = std::numbers::pi_v<float>;
-                    float newFov = atanf((tanf(yml.fix.fov.value * pi / 360.0f) / nativeAspectRatio) * yml.resolution.aspectRatio) * 360.0f / pi;
-                    newFov *= (ctx.xmm0.f32[0] / inGameSetFov);
-                    ctx.xmm0.f32[0] = newFov;
-                }
-            );
-            LOG("Hooked @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset, hookRelAddr);
-        }
-        else {
-            LOG("Did not find '{}'", patternFind);
-        }
-    }
+    fixRegistry.push_back({ // Master FOV controller
+        .name = "Fov",
+        .signature = MasterFov,
+        // movss [rbx+00000F48],xmm0
+        .site = { .mnemonic = ZYDIS_MNEMONIC_MOVSS, .source = ZYDIS_REGISTER_XMM0 },
+        .kind = MidHook,
+        .callback = [](SafetyHookContext& ctx) {
+            Stats::Scope scope(MasterFov);
+            Trace::HookScope trace(MasterFov, ctx.xmm0.f32[0]);
+            ctx.xmm0.f32[0] *= hotState.load(std::memory_order_acquire)->fovScale;
+            trace.setOutput(ctx.xmm0.f32[0]);
+        },
+        .enabled = [](const yml_t& cfg) {
+            return cfg.masterEnable && cfg.fix.fov.enable;
+        },
+    });
 }
 
 /**
  * @brief Feature that will scale the sprint FOV value based on the user provided value in the config file.
  *
  * This function performs the following tasks:
- * 1. Checks if the scaleSprintFov feature is enabled based on the configuration.
- * 2. Searches for a specific memory pattern in the base module.
- * 3. Hooks the identified pattern so that the sprint FOV is scaled.
+ * 1. Registers a hook in `fixRegistry` that scales the sprint FOV, applied by `applyFixes()`
+ *      if the scaleSprintFov feature is enabled based on the configuration.
  *
  * @details
  * The function uses a pattern scan to find a specific byte sequence in the memory of the base module.
@@ -477,61 +1518,156 @@ void fovFix() {
  * @return void
  */
 void scaleSprintFovFeature() {
-    const char* patternFind  = "F3 0F 10 80 3C 07 00 00    C3    CC";
-    uintptr_t hookOffset = 8;
+    fixRegistry.push_back({
+        .name = "ScaleSprintFov",
+        .signature = SprintFov,
+        .site = { .mnemonic = ZYDIS_MNEMONIC_RET },
+        .kind = MidHook,
+        .callback = [](SafetyHookContext& ctx) {
+            Stats::Scope scope(SprintFov);
+            Trace::HookScope trace(SprintFov, ctx.xmm0.f32[0]);
+            auto state = hotState.load(std::memory_order_acquire);
+            float deltaFov = (ctx.xmm0.f32[0] - state->inGameSetFov);
+            HOOK_LOG("{}", deltaFov);
+            ctx.xmm0.f32[0] = state->inGameSetFov + (deltaFov * state->sprintFovScale);
+            trace.setOutput(ctx.xmm0.f32[0]);
+        },
+        .enabled = [](const yml_t& cfg) {
+            return cfg.masterEnable && cfg.feature.scaleSprintFov.enable;
+        },
+    });
+}
 
-    bool enable = yml.masterEnable & yml.feature.scaleSprintFov.enable;
+/**
+ * @brief Applies the frameLimiter feature by pacing the game's Present calls.
+ *
+ * This function performs the following tasks:
+ * 1. Checks if the feature is enabled based on the configuration.
+ * 2. Registers the frame limiter to run before every frame is presented.
+ *
+ * @details
+ * The game's own frame cap is coarse and paces frames unevenly on high refresh rate displays.
+ * Instead every frame is held back right before it is presented until one frame period passed
+ * since the previous one, see `FrameLimiter::start()` for how the wait is done. The in game
+ * frame cap and vsync should be disabled when using this, or they will fight over the pacing.
+ *
+ * The Present hook itself is installed later by `presentHook()`, along with everything else
+ * that runs once per frame.
+ *
+ * @return void
+ */
+void frameLimiterFeature() {
+    bool enable = yml.masterEnable & yml.feature.frameLimiter.enable;
     LOG("Feature {}", enable ? "Enabled" : "Disabled");
     if (enable) {
-        std::vector<uint64_t> addr;
-        Utils::patternScan(baseModule, patternFind, &addr);
-        uint8_t* hit = (uint8_t*)addr[0];
-        uintptr_t absAddr = (uintptr_t)hit;
-        uintptr_t relAddr = (uintptr_t)hit - (uintptr_t)baseModule;
-        if (hit) {
-            LOG("Found '{}' @ 0x{:x}", patternFind, relAddr);
-            uintptr_t hookAbsAddr = absAddr + hookOffset;
-            uintptr_t hookRelAddr = relAddr + hookOffset;
-            static SafetyHookMid fovMidHook{};
-            fovMidHook = safetyhook::create_mid(reinterpret_cast<void*>(hookAbsAddr),
-                [](SafetyHookContext& ctx) {
-                    float deltaFov = (ctx.xmm0.f32[0] - inGameSetFov);
-                    LOG("{}", deltaFov);
-                    ctx.xmm0.f32[0] = inGameSetFov + (deltaFov * yml.feature.scaleSprintFov.value);
-                }
-            );
-            LOG("Hooked @ 0x{:x} + 0x{:x} = 0x{:x}", relAddr, hookOffset, hookRelAddr);
+        if (FrameLimiter::start(yml.feature.frameLimiter.fps)) {
+            LOG("Limiting to {} fps", yml.feature.frameLimiter.fps);
         }
         else {
-            LOG("Did not find '{}'", patternFind);
+            LOG("Failed to limit to {} fps", yml.feature.frameLimiter.fps);
         }
     }
 }
 
+/**
+ * @brief Hooks the game's Present call for everything that has to run once per frame.
+ *
+ * This function performs the following tasks:
+ * 1. Starts capturing frame times, if enabled.
+ * 2. Hooks IDXGISwapChain::Present, if anything was registered to run on it.
+ *
+ * @details
+ * Frame times are written to BorderlandsGOTYEnhancedFix.frametimes.csv, one line per frame.
+ * They are captured regardless of masterEnable, so that the frame pacing of the game with and
+ * without the fixes can be compared.
+ *
+ * @return void
+ */
+void presentHook() {
+    Timing::Phase phase(__func__);
+    std::string frameTimesPath = dllFile("BorderlandsGOTYEnhancedFix.frametimes.csv");
+
+    bool enable = yml.advanced.frameTimes.enable;
+    LOG("Frame times {}", enable ? "Enabled" : "Disabled");
+    if (enable) {
+        if (FrameTimes::start(frameTimesPath.c_str())) {
+            LOG("Capturing frame times to {}", frameTimesPath);
+        }
+        else {
+            LOG("Failed to capture frame times to {}", frameTimesPath);
+        }
+    }
+
+    if (!Present::install()) {
+        LOG("Failed to hook Present");
+    }
+    else if (Present::installed) {
+        LOG("Present hooked");
+    }
+    else {
+        LOG("Present not hooked, nothing uses it");
+    }
+}
+
 /**
  * @brief Main function that initializes and applies various fixes and features.
  *
  * This function serves as the entry point for the DLL. It performs the following tasks:
- * 1. Initializes the logging system.
- * 2. Reads the configuration from a YAML file.
- * 3. Sleeps for 5 second to give the game time to load up, fixes won't work otherwise,
+ * 1. Reads the configuration from a YAML file, or its cache, and initializes the logging
+ *      system with it, then moves this thread to the configured priority and cores.
+ * 2. Publishes the values the hooks read, and starts recording calls to the hooks and publishing
+ *      telemetry if enabled.
+ * 3. Loads the signature cache, and waits for the game to write its resolution, fixes won't work otherwise,
  *      and patched resolution will be overwritten by the game.
  * 4. Applies a resolution fix.
  * 5. Applies a field of view (FOV) fix.
- * 6. Applies the scaleSprintFov feature.
+ * 6. Applies the scaleSprintFov and frameLimiter features.
+ * 7. Scans for the signatures of the enabled fixes and features, and hooks them one after another.
+ *      Then patches the resolution slots, with the hooks already in place.
+ * 8. Hooks the game's Present call for everything that runs once per frame.
+ *      Then logs how long every phase of startup took, see `Timing::logSummary()`.
+ * 9. Watches the YAML file and reloads it when it changes, if enabled.
  *
  * @param lpParameter Unused parameter.
  * @return Always returns TRUE to indicate successful execution.
  */
 DWORD __stdcall Main(void* lpParameter) {
-    logInit();
     readYml();
-    Sleep(5000); // TODO: Find a better solution
+    logInit();
+    logYml();
+    applyScheduling();
+    publishHotState(yml);
+    if (yml.advanced.stats.enable) {
+        Stats::init(signatureNames, yml.advanced.stats.interval);
+    }
+    if (yml.advanced.telemetry.enable) {
+        if (Telemetry::start(signatureNames)) {
+            LOG("Publishing telemetry to {}", Telemetry::mappingName);
+        }
+    }
+    loadCache();
+    waitForGame();
     // Fixes
     resolutionFix();
     fovFix();
     // Features
     scaleSprintFovFeature();
+    frameLimiterFeature();
+    scanSignatures();
+    applyFixes();
+    patchResolutionSlots();
+    // Telemetry
+    presentHook();
+    // Startup timing
+    Timing::stop();
+    Timing::logSummary();
+    if (yml.advanced.timing.json && !Timing::writeJson(dllFile("BorderlandsGOTYEnhancedFix.timing.json").c_str())) {
+        LOG("Failed to write startup timing");
+    }
+    // Reloading
+    if (yml.masterEnable && yml.advanced.reload.enable) {
+        ymlWatcher(nullptr);
+    }
     return true;
 }
 
@@ -547,8 +1683,8 @@ DWORD __stdcall Main(void* lpParameter) {
  * different reasons for the call specified by `ul_reason_for_call`. In this implementation:
  *
  * - **DLL_PROCESS_ATTACH**: When the DLL is loaded into the address space of a process, it
- *   creates a new thread to run the `Main` function. The thread priority is set to the highest,
- *   and the thread handle is closed after creation.
+ *   saves the folder it was loaded from in `dllDirectory` and creates a new thread to run the `Main` function, and the thread handle is closed after creation.
+ *   `Main` sets its own priority once the configuration is read, see `applyScheduling()`.
  *
  * - **DLL_THREAD_ATTACH**: Called when a new thread is created in the process. No action is taken
  *   in this implementation.
@@ -556,7 +1692,8 @@ DWORD __stdcall Main(void* lpParameter) {
  * - **DLL_THREAD_DETACH**: Called when a thread exits cleanly. No action is taken in this implementation.
  *
  * - **DLL_PROCESS_DETACH**: Called when the DLL is unloaded from the address space of a process.
- *   No action is taken in this implementation.
+ *   The ETW provider is unregistered. Nothing is logged, the loader lock is held and the other
+ *   threads have already been killed, one of them may have been holding a lock of spdlog.
  *
  * @param hModule Handle to the DLL module. This parameter is used to identify the DLL.
  * @param ul_reason_for_call Indicates the reason for the call (e.g., process attach, thread attach).
@@ -571,16 +1708,26 @@ BOOL APIENTRY DllMain(
     HANDLE mainHandle;
     switch (ul_reason_for_call) {
     case DLL_PROCESS_ATTACH:
+        {
+            WCHAR dllPath[_MAX_PATH] = { 0 };
+            DWORD length = GetModuleFileNameW(hModule, dllPath, MAX_PATH);
+            if (length > 0 && length < MAX_PATH) {
+                dllDirectory = std::filesystem::path(dllPath).parent_path();
+            }
+        }
+        Trace::init();
+        Timing::start();
         LOG("DLL_PROCESS_ATTACH");
         mainHandle = CreateThread(NULL, 0, Main, 0, NULL, 0);
         if (mainHandle)
         {
-            SetThreadPriority(mainHandle, THREAD_PRIORITY_HIGHEST);
             CloseHandle(mainHandle);
         }
     case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
+        break;
     case DLL_PROCESS_DETACH:
+        Trace::shutdown();
         break;
     }
     return TRUE;
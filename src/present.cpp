@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi.h>
+#include <cstdint>
+
+#include "safetyhook.hpp"
+
+#include "present.hpp"
+
+namespace
+{
+    typedef struct callback_t {
+        Present::PresentCallback function;
+        void* context;
+    } callback_t;
+
+    callback_t callbacks[Present::maxCallbacks];
+    size_t callbackCount = 0;
+
+    SafetyHookInline presentHook{};
+
+    /*
+     * Index of Present in the IDXGISwapChain vtable, after the 3 IUnknown, 4 IDXGIObject and
+     * 1 IDXGIDeviceSubObject methods.
+     */
+    constexpr size_t presentIndex = 8;
+
+    HRESULT __stdcall onPresent(IDXGISwapChain* swapChain, UINT syncInterval, UINT flags) {
+        for (size_t i = 0; i < callbackCount; i++) {
+            callbacks[i].function(swapChain, callbacks[i].context);
+        }
+        return presentHook.call<HRESULT>(swapChain, syncInterval, flags);
+    }
+
+    void* findPresent() {
+        WNDCLASSEXW windowClass = {};
+        windowClass.cbSize = sizeof(windowClass);
+        windowClass.lpfnWndProc = DefWindowProcW;
+        windowClass.hInstance = GetModuleHandleW(NULL);
+        windowClass.lpszClassName = L"BorderlandsGOTYEnhancedFixPresent";
+        RegisterClassExW(&windowClass);
+        HWND window = CreateWindowExW(0, windowClass.lpszClassName, L"", WS_OVERLAPPEDWINDOW,
+            0, 0, 16, 16, NULL, NULL, windowClass.hInstance, NULL
+        );
+
+        DXGI_SWAP_CHAIN_DESC desc = {};
+        desc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        desc.BufferCount = 1;
+        desc.OutputWindow = window;
+        desc.Windowed = TRUE;
+        desc.SwapEffect = DXGI_SWAP_EFFECT_DISCARD;
+
+        void* present = nullptr;
+        // WARP in case the GPU is busy or refuses a second device, the vtable is the same
+        for (D3D_DRIVER_TYPE driverType : { D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP }) {
+            IDXGISwapChain* swapChain = nullptr;
+            ID3D11Device* device = nullptr;
+            ID3D11DeviceContext* context = nullptr;
+            HRESULT result = D3D11CreateDeviceAndSwapChain(NULL, driverType, NULL, 0, NULL, 0,
+                D3D11_SDK_VERSION, &desc, &swapChain, &device, NULL, &context
+            );
+            if (SUCCEEDED(result)) {
+                present = (*reinterpret_cast<void***>(swapChain))[presentIndex];
+                swapChain->Release();
+                device->Release();
+                context->Release();
+                break;
+            }
+        }
+
+        DestroyWindow(window);
+        UnregisterClassW(windowClass.lpszClassName, windowClass.hInstance);
+        return present;
+    }
+}
+
+namespace Present
+{
+    bool installed = false;
+
+    bool addCallback(PresentCallback callback, void* context) {
+        if (installed || callbackCount == maxCallbacks) {
+            return false;
+        }
+        callbacks[callbackCount++] = { callback, context };
+        return true;
+    }
+
+    bool install() {
+        if (installed || callbackCount == 0) {
+            return true;
+        }
+        void* present = findPresent();
+        if (!present) {
+            return false;
+        }
+        presentHook = safetyhook::create_inline(present, reinterpret_cast<void*>(onPresent));
+        installed = (bool)presentHook;
+        return installed;
+    }
+}
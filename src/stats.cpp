@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
+
+#include "spdlog/spdlog.h"
+
+#include "stats.hpp"
+
+// Macros
+#define LOG(STRING, ...) spdlog::info("{} : " STRING, __func__, ##__VA_ARGS__)
+
+namespace
+{
+    /*
+     * Bucket `i` of a histogram counts calls that took less than 2^i cycles, the last bucket
+     * also counts everything longer than that.
+     */
+    constexpr size_t bucketCount = 32;
+
+    /*
+     * Threads are given slots round robin, if there are more threads calling the hooks than
+     * there are slots they share them. Counters are atomic, so that only costs contention.
+     */
+    constexpr size_t maxSlots = 64;
+
+    typedef struct alignas(64) slot_t {
+        std::atomic<uint64_t> calls[Stats::maxHooks];
+        std::atomic<uint64_t> cycles[Stats::maxHooks];
+        std::atomic<uint64_t> buckets[Stats::maxHooks][bucketCount];
+    } slot_t;
+
+    slot_t slots[maxSlots];
+    std::atomic<size_t> nextSlot = 0;
+    std::span<const char* const> hookNames;
+
+    slot_t& threadSlot() {
+        thread_local slot_t* slot = &slots[nextSlot.fetch_add(1, std::memory_order_relaxed) % maxSlots];
+        return *slot;
+    }
+
+    uint64_t percentile(const uint64_t (&buckets)[bucketCount], uint64_t calls, double fraction) {
+        uint64_t target = std::max<uint64_t>(1, (uint64_t)(calls * fraction));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < bucketCount; i++) {
+            seen += buckets[i];
+            if (seen >= target) {
+                return (uint64_t)1 << i;
+            }
+        }
+        return (uint64_t)1 << (bucketCount - 1);
+    }
+}
+
+namespace Stats
+{
+    bool enabled = false;
+
+    void init(std::span<const char* const> names, unsigned interval) {
+        hookNames = names.first(std::min(names.size(), maxHooks));
+        enabled = true;
+        std::thread([interval]() {
+            while (true) {
+                std::this_thread::sleep_for(std::chrono::seconds(interval));
+                logSummary();
+            }
+        }).detach();
+    }
+
+    void record(size_t hook, uint64_t cycles) {
+        slot_t& slot = threadSlot();
+        size_t bucket = std::min<size_t>(std::bit_width(cycles), bucketCount - 1);
+        slot.calls[hook].fetch_add(1, std::memory_order_relaxed);
+        slot.cycles[hook].fetch_add(cycles, std::memory_order_relaxed);
+        slot.buckets[hook][bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void logSummary() {
+        for (size_t hook = 0; hook < hookNames.size(); hook++) {
+            uint64_t calls = 0;
+            uint64_t cycles = 0;
+            uint64_t buckets[bucketCount] = {};
+            for (const slot_t& slot : slots) {
+                calls += slot.calls[hook].load(std::memory_order_relaxed);
+                cycles += slot.cycles[hook].load(std::memory_order_relaxed);
+                for (size_t i = 0; i < bucketCount; i++) {
+                    buckets[i] += slot.buckets[hook][i].load(std::memory_order_relaxed);
+                }
+            }
+            if (calls == 0) {
+                LOG("{}: 0 calls", hookNames[hook]);
+                continue;
+            }
+            LOG("{}: {} calls, mean {} cycles, p50 < {} cycles, p99 < {} cycles",
+                hookNames[hook], calls, cycles / calls,
+                percentile(buckets, calls, 0.50),
+                percentile(buckets, calls, 0.99)
+            );
+        }
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <windows.h>
+#include <atomic>
+#include <bit>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#include "spdlog/spdlog.h"
+
+#include "present.hpp"
+#include "telemetry.hpp"
+
+// Macros
+#define WARN(STRING, ...) spdlog::warn("{} : " STRING, __func__, ##__VA_ARGS__)
+
+namespace
+{
+    Telemetry::telemetry_t* shared = nullptr;
+
+    /*
+     * Only ever touched by the render thread.
+     */
+    int64_t previousPresent = 0;
+    int64_t ticksPerMicrosecond = 1;
+
+    size_t bucket(uint64_t value) {
+        return std::min<size_t>(std::bit_width(value), Telemetry::bucketCount - 1);
+    }
+
+    /*
+     * Zeroes every counter of a mapping that was left behind by an earlier session, or is
+     * still published by another instance of the game.
+     */
+    void resetCounters(Telemetry::telemetry_t* view) {
+        auto& frame = view->frame;
+        frame.frames.store(0, std::memory_order_relaxed);
+        frame.lastPresent.store(0, std::memory_order_relaxed);
+        frame.lastFrameTime.store(0, std::memory_order_relaxed);
+        for (auto& count : frame.buckets) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        for (auto& hook : view->hooks) {
+            hook.calls.store(0, std::memory_order_relaxed);
+            hook.cycles.store(0, std::memory_order_relaxed);
+            for (auto& count : hook.buckets) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+        memset(view->hookNames, 0, sizeof(view->hookNames));
+    }
+
+    void onPresent(IDXGISwapChain* swapChain, void* context) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        auto& frame = shared->frame;
+        if (previousPresent) {
+            uint64_t frameTime = (uint64_t)(now.QuadPart - previousPresent) / ticksPerMicrosecond;
+            frame.lastFrameTime.store(frameTime, std::memory_order_relaxed);
+            frame.buckets[bucket(frameTime)].fetch_add(1, std::memory_order_relaxed);
+        }
+        frame.lastPresent.store(now.QuadPart, std::memory_order_relaxed);
+        frame.frames.fetch_add(1, std::memory_order_relaxed);
+        previousPresent = now.QuadPart;
+    }
+}
+
+namespace Telemetry
+{
+    bool enabled = false;
+
+    bool start(std::span<const char* const> names) {
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(telemetry_t), mappingName);
+        if (!mapping) {
+            WARN("Telemetry disabled, failed to create {}: error {}", mappingName, GetLastError());
+            return false;
+        }
+        bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+        // The mapping is never unmapped, readers may keep it open past the game's exit
+        auto view = (telemetry_t*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(telemetry_t));
+        if (!view) {
+            WARN("Telemetry disabled, failed to map {}: error {}", mappingName, GetLastError());
+            CloseHandle(mapping);
+            return false;
+        }
+        if (!Present::addCallback(onPresent)) {
+            WARN("Telemetry disabled, failed to add a Present callback");
+            UnmapViewOfFile(view);
+            CloseHandle(mapping);
+            return false;
+        }
+
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        ticksPerMicrosecond = std::max<int64_t>(1, frequency.QuadPart / 1000000);
+
+        // A new mapping is zero filled, one still held open by a reader has to be reset first
+        view->magic.store(0, std::memory_order_relaxed);
+        view->generation.fetch_add(1, std::memory_order_acq_rel);
+        if (existed) {
+            WARN("{} already existed, pid {} published to it last, resetting it",
+                mappingName, view->processId
+            );
+            resetCounters(view);
+        }
+        view->version = version;
+        view->size = sizeof(telemetry_t);
+        view->processId = GetCurrentProcessId();
+        view->qpcFrequency = frequency.QuadPart;
+        view->hookCount = (uint32_t)std::min(names.size(), maxHooks);
+        for (size_t i = 0; i < view->hookCount; i++) {
+            size_t length = std::min(strlen(names[i]), sizeof(view->hookNames[i]) - 1);
+            memcpy(view->hookNames[i], names[i], length);
+        }
+        view->magic.store(magic, std::memory_order_release);
+        shared = view;
+        enabled = true;
+        return true;
+    }
+
+    void recordHook(size_t hook, uint64_t cycles) {
+        auto& counters = shared->hooks[hook];
+        counters.calls.fetch_add(1, std::memory_order_relaxed);
+        counters.cycles.fetch_add(cycles, std::memory_order_relaxed);
+        counters.buckets[bucket(cycles)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
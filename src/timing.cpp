@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <fstream>
+#include <format>
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+#include "spdlog/spdlog.h"
+
+#include "timing.hpp"
+
+// Macros
+#define LOG(STRING, ...) spdlog::info("{} : " STRING, __func__, ##__VA_ARGS__)
+
+namespace
+{
+    typedef struct phase_t {
+        const char* name;
+        int64_t ticks;
+        uint32_t count;
+    } phase_t;
+
+    phase_t phases[Timing::maxPhases];
+    size_t phaseCount = 0;
+    int64_t startTicks = 0;
+    int64_t stopTicks = 0;
+
+    int64_t now() {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return counter.QuadPart;
+    }
+
+    double toMs(int64_t ticks) {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return (double)ticks * 1000.0 / (double)frequency.QuadPart;
+    }
+
+    double totalMs() {
+        return toMs((stopTicks ? stopTicks : now()) - startTicks);
+    }
+}
+
+namespace Timing
+{
+    void start() {
+        startTicks = now();
+        stopTicks = 0;
+    }
+
+    void stop() {
+        stopTicks = now();
+    }
+
+    void record(const char* name, int64_t ticks) {
+        for (size_t i = 0; i < phaseCount; i++) {
+            if (strcmp(phases[i].name, name) == 0) {
+                phases[i].ticks += ticks;
+                phases[i].count++;
+                return;
+            }
+        }
+        if (phaseCount < maxPhases) {
+            phases[phaseCount++] = { name, ticks, 1 };
+        }
+    }
+
+    void logSummary() {
+        std::string line = std::format("total={:.2f}ms", totalMs());
+        for (size_t i = 0; i < phaseCount; i++) {
+            auto& phase = phases[i];
+            line += std::format(" {}={:.2f}ms", phase.name, toMs(phase.ticks));
+            if (phase.count > 1) {
+                line += std::format("x{}", phase.count);
+            }
+        }
+        LOG("{}", line);
+    }
+
+    bool writeJson(const char* path) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << std::format("{{\n  \"total_ms\": {:.3f},\n  \"phases\": [", totalMs());
+        for (size_t i = 0; i < phaseCount; i++) {
+            auto& phase = phases[i];
+            file << std::format("{}\n    {{ \"name\": \"{}\", \"ms\": {:.3f}, \"count\": {} }}",
+                i ? "," : "", phase.name, toMs(phase.ticks), phase.count);
+        }
+        file << "\n  ]\n}\n";
+        return (bool)file;
+    }
+}
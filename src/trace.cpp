@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Dominik Protasewicz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <windows.h>
+#include <TraceLoggingProvider.h>
+#include <cstdint>
+
+#include "trace.hpp"
+
+TRACELOGGING_DEFINE_PROVIDER(traceProvider, "BorderlandsGOTYEnhancedFix",
+    // 2ba3de7d-36b2-5ed8-22aa-1e7efeab592f
+    (0x2ba3de7d, 0x36b2, 0x5ed8, 0x22, 0xaa, 0x1e, 0x7e, 0xfe, 0xab, 0x59, 0x2f));
+
+namespace Trace
+{
+    void init() {
+        TraceLoggingRegister(traceProvider);
+    }
+
+    void shutdown() {
+        TraceLoggingUnregister(traceProvider);
+    }
+
+    void phaseStart(const char* name) {
+        TraceLoggingWrite(traceProvider, "Phase",
+            TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+            TraceLoggingKeyword(keywordPhase),
+            TraceLoggingOpcode(WINEVENT_OPCODE_START),
+            TraceLoggingString(name, "Name"));
+    }
+
+    void phaseStop(const char* name, int64_t ticks) {
+        TraceLoggingWrite(traceProvider, "Phase",
+            TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+            TraceLoggingKeyword(keywordPhase),
+            TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+            TraceLoggingString(name, "Name"),
+            TraceLoggingInt64(ticks, "Ticks"));
+    }
+
+    void hook(size_t hook, float input, float output, uint64_t cycles) {
+        TraceLoggingWrite(traceProvider, "Hook",
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+            TraceLoggingKeyword(keywordHook),
+            TraceLoggingUInt32((uint32_t)hook, "Hook"),
+            TraceLoggingFloat32(input, "Input"),
+            TraceLoggingFloat32(output, "Output"),
+            TraceLoggingUInt64(cycles, "Cycles"));
+    }
+}
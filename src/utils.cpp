@@ -27,9 +27,896 @@
 #include <format>
 #include <iostream>
 #include <cstdint>
+#include <bit>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <optional>
+#include <intrin.h>
+#include <immintrin.h>
 
 #include "utils.hpp"
 
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace
+{
+    /*
+     * Longest pattern that can be parsed at runtime. Patterns are held in fixed arrays on the
+     * stack so that parsing and scanning one allocates nothing, a longer pattern is treated
+     * like one made up of only wildcards and never matches.
+     */
+    constexpr size_t maxPatternSize = 256;
+
+    /*
+     * Pattern parsed at runtime, laid out like `Utils::SignatureView`. A mask byte of 0xFF
+     * means the byte has to match, 0x00 is a wildcard.
+     */
+    typedef struct pattern_t {
+        uint8_t bytes[maxPatternSize];
+        uint8_t mask[maxPatternSize];
+        size_t size;
+        size_t anchor0; // Offset of the rarest non-wildcard byte
+        size_t anchor1; // Offset of the second rarest non-wildcard byte
+    } pattern_t;
+
+    typedef struct anchor_t {
+        size_t index;
+        size_t offset;
+    } anchor_t;
+
+    typedef struct range_t {
+        uint8_t* base;
+        size_t size;
+    } range_t;
+
+    /*
+     * The Windows loader refuses images with more than 96 sections. A section is only split
+     * into more than one range where some of its pages can't be read, which does not happen in
+     * an image the loader mapped, so a fixed array is always large enough to hold the ranges
+     * to scan without going to the heap.
+     */
+    constexpr size_t maxSections = 96;
+    constexpr size_t maxRanges = 4 * maxSections;
+
+    typedef struct ranges_t {
+        range_t range[maxRanges];
+        size_t count;
+    } ranges_t;
+
+    bool isReadable(const MEMORY_BASIC_INFORMATION& info) {
+        constexpr DWORD readable = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY |
+            PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+        return info.State == MEM_COMMIT && (info.Protect & readable) && !(info.Protect & PAGE_GUARD);
+    }
+
+    /*
+     * Adds the pages of [base, base + size) that can be read to `ranges`. Pages that are not
+     * committed, guard pages and pages without read access are skipped, as reading them would
+     * fault. If a region can't be queried the rest is added as is, like before the query.
+     */
+    void addReadableRanges(ranges_t& ranges, uint8_t* base, size_t size) {
+        uint8_t* end = base + size;
+        uint8_t* begin = nullptr;
+        uint8_t* current = base;
+        while (current < end) {
+            MEMORY_BASIC_INFORMATION info;
+            if (!VirtualQuery(current, &info, sizeof(info))) {
+                begin = begin ? begin : current;
+                current = end;
+                break;
+            }
+            uint8_t* regionEnd = std::min(end, (uint8_t*)info.BaseAddress + info.RegionSize);
+            if (isReadable(info)) {
+                begin = begin ? begin : current;
+            }
+            else if (begin) {
+                if (ranges.count < maxRanges) {
+                    ranges.range[ranges.count++] = { begin, (size_t)(current - begin) };
+                }
+                begin = nullptr;
+            }
+            current = regionEnd;
+        }
+        if (begin && ranges.count < maxRanges) {
+            ranges.range[ranges.count++] = { begin, (size_t)(end - begin) };
+        }
+    }
+
+    /*
+     * Looks up a kernel32 export at runtime. Functions newer than Windows 7 must never be
+     * imported directly, the game still runs there and the whole ASI would fail to load.
+     */
+    template <typename Fn>
+    Fn kernel32Function(const char* name) {
+        return reinterpret_cast<Fn>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), name));
+    }
+
+    /*
+     * Asks the memory manager to page in all `ranges` ahead of the scan. Pages of the image
+     * that were never touched are otherwise read from disk one fault at a time as the scan
+     * reaches them, prefetching reads them in large sequential requests instead. Windows 7
+     * has no PrefetchVirtualMemory, the pages are then faulted in by the scan as before.
+     */
+    void prefetchRanges(const ranges_t& ranges) {
+        static const auto prefetch = kernel32Function<decltype(&PrefetchVirtualMemory)>("PrefetchVirtualMemory");
+        if (!prefetch) {
+            return;
+        }
+        WIN32_MEMORY_RANGE_ENTRY entries[maxRanges];
+        for (size_t i = 0; i < ranges.count; i++) {
+            entries[i] = { ranges.range[i].base, ranges.range[i].size };
+        }
+        if (ranges.count) {
+            prefetch(GetCurrentProcess(), ranges.count, entries, 0);
+        }
+    }
+
+    typedef struct chunk_t {
+        range_t range;
+        size_t begin;
+        size_t end;
+    } chunk_t;
+
+    typedef struct batch_hits_t {
+        std::vector<std::vector<uint64_t>> address;
+        size_t maxMatches;
+        size_t pending; // Signatures that have not reached `maxMatches` yet
+    } batch_hits_t;
+
+    template <typename Pattern>
+    using scan_kernel_t = bool (*)(const uint8_t* scanBytes, size_t count, const Pattern& pattern, Utils::ScanCallback callback, void* context);
+
+    /*
+     * Collects the sections of `module` to scan. With no `section` name given every section
+     * flagged with any of `characteristics` is returned, otherwise only the section with that
+     * name. Section sizes are clamped to `SizeOfImage` so a scan never reads past the mapped
+     * image, and pages of a section that can't be read are left out. The ranges are prefetched
+     * before they are returned.
+     */
+    ranges_t getScanRanges(void* module, const char* section, DWORD characteristics = IMAGE_SCN_MEM_EXECUTE) {
+        auto dosHeader = (PIMAGE_DOS_HEADER)module;
+        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
+        auto sectionHeader = IMAGE_FIRST_SECTION(ntHeaders);
+
+        ranges_t ranges = {};
+        auto sections = std::min<size_t>(ntHeaders->FileHeader.NumberOfSections, maxSections);
+        for (size_t i = 0; i < sections; i++, sectionHeader++) {
+            if (section) {
+                if (strncmp((const char*)sectionHeader->Name, section, IMAGE_SIZEOF_SHORT_NAME) != 0) {
+                    continue;
+                }
+            }
+            else if (!(sectionHeader->Characteristics & characteristics)) {
+                continue;
+            }
+            size_t begin = sectionHeader->VirtualAddress;
+            size_t size = sectionHeader->Misc.VirtualSize ? sectionHeader->Misc.VirtualSize : sectionHeader->SizeOfRawData;
+            if (begin >= sizeOfImage) {
+                continue;
+            }
+            size = std::min(size, sizeOfImage - begin);
+            addReadableRanges(ranges, (uint8_t*)module + begin, size);
+        }
+        prefetchRanges(ranges);
+        return ranges;
+    }
+
+    unsigned scanThreads = 1;
+
+    /*
+     * Policy set through `Utils::setScheduling`, scan workers apply it to themselves so that
+     * they run exactly like the thread that started the scan. `cpuSets` holds the CPU sets of
+     * the efficiency cores, empty if the policy doesn't ask for them or the CPU has none.
+     */
+    Utils::SchedulingPolicy scheduling = { Utils::ThreadPriority::Normal, false, false };
+    bool schedulingSet = false;
+    std::vector<ULONG> cpuSets;
+
+    /*
+     * CPU sets only exist since Windows 10, on older versions these stay `nullptr` and the
+     * threads may run on any core.
+     */
+    decltype(&GetSystemCpuSetInformation) getSystemCpuSetInformation = nullptr;
+    decltype(&SetThreadSelectedCpuSets) setThreadSelectedCpuSets = nullptr;
+
+    /*
+     * CPU sets of the lowest efficiency class. A CPU whose cores are all of the same class has
+     * no efficiency cores, in which case nothing is returned, same as without CPU set support.
+     */
+    std::vector<ULONG> efficiencyCpuSets() {
+        getSystemCpuSetInformation = kernel32Function<decltype(&GetSystemCpuSetInformation)>("GetSystemCpuSetInformation");
+        setThreadSelectedCpuSets = kernel32Function<decltype(&SetThreadSelectedCpuSets)>("SetThreadSelectedCpuSets");
+        if (!getSystemCpuSetInformation || !setThreadSelectedCpuSets) {
+            return {};
+        }
+        ULONG length = 0;
+        getSystemCpuSetInformation(nullptr, 0, &length, GetCurrentProcess(), 0);
+        if (length == 0) {
+            return {};
+        }
+        std::vector<uint8_t> buffer(length);
+        if (!getSystemCpuSetInformation((PSYSTEM_CPU_SET_INFORMATION)buffer.data(), length, &length, GetCurrentProcess(), 0)) {
+            return {};
+        }
+
+        BYTE lowest = 0xFF;
+        BYTE highest = 0;
+        for (ULONG offset = 0; offset < length; ) {
+            auto info = (PSYSTEM_CPU_SET_INFORMATION)&buffer[offset];
+            if (info->Type == CpuSetInformation) {
+                lowest = std::min(lowest, info->CpuSet.EfficiencyClass);
+                highest = std::max(highest, info->CpuSet.EfficiencyClass);
+            }
+            offset += info->Size;
+        }
+        std::vector<ULONG> ids;
+        for (ULONG offset = 0; lowest < highest && offset < length; ) {
+            auto info = (PSYSTEM_CPU_SET_INFORMATION)&buffer[offset];
+            if (info->Type == CpuSetInformation && info->CpuSet.EfficiencyClass == lowest) {
+                ids.push_back(info->CpuSet.Id);
+            }
+            offset += info->Size;
+        }
+        return ids;
+    }
+
+    /*
+     * Applies `scheduling` to the calling thread. Background mode also lowers the I/O and
+     * memory priority of the thread, not only its CPU priority.
+     */
+    bool applyScheduling() {
+        auto thread = GetCurrentThread();
+        bool applied;
+        switch (scheduling.priority) {
+        case Utils::ThreadPriority::Background:
+            applied = SetThreadPriority(thread, THREAD_MODE_BACKGROUND_BEGIN);
+            break;
+        case Utils::ThreadPriority::High:
+            applied = SetThreadPriority(thread, THREAD_PRIORITY_HIGHEST);
+            break;
+        default:
+            applied = SetThreadPriority(thread, THREAD_PRIORITY_NORMAL);
+            break;
+        }
+        if (!cpuSets.empty()) {
+            applied &= setThreadSelectedCpuSets(thread, cpuSets.data(), (ULONG)cpuSets.size()) != FALSE;
+        }
+        return applied;
+    }
+
+    /*
+     * Gives the rest of the calling thread's time slice to another thread between two chunks
+     * of a scan, if the policy asks for it.
+     */
+    void yieldChunk() {
+        if (scheduling.yield) {
+            SwitchToThread();
+        }
+    }
+
+    /*
+     * Chunks smaller than this are not worth handing to another thread, the cost of spinning
+     * up the thread would outweigh the time it takes to scan.
+     */
+    constexpr size_t minChunkSize = 256 * 1024;
+
+    unsigned getThreadCount() {
+        if (scanThreads == 0) {
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+        return scanThreads;
+    }
+
+    /*
+     * Splits the scan ranges into chunks of offsets for the worker threads. More chunks than
+     * threads are created so that a thread that finishes early can pick up another chunk.
+     * When scanning with a single thread every range is a single chunk.
+     */
+    std::vector<chunk_t> splitRanges(const ranges_t& ranges) {
+        size_t total = 0;
+        for (size_t i = 0; i < ranges.count; i++) {
+            total += ranges.range[i].size;
+        }
+
+        auto threads = getThreadCount();
+        size_t chunkSize = threads > 1 ? std::max(minChunkSize, total / (threads * 4)) : SIZE_MAX;
+
+        std::vector<chunk_t> chunks;
+        for (size_t i = 0; i < ranges.count; i++) {
+            auto& range = ranges.range[i];
+            for (size_t begin = 0; begin < range.size; ) {
+                size_t end = chunkSize < range.size - begin ? begin + chunkSize : range.size;
+                chunks.push_back({ range, begin, end });
+                begin = end;
+            }
+        }
+        return chunks;
+    }
+
+    /*
+     * Runs `fn(i)` for every `i` in [0, count) on up to `getThreadCount()` threads, the calling
+     * thread being one of them. Returns once every call has completed.
+     */
+    template <typename Fn>
+    void parallelFor(size_t count, Fn&& fn) {
+        size_t threads = std::min<size_t>(getThreadCount(), count);
+        if (threads <= 1) {
+            for (size_t i = 0; i < count; i++) {
+                fn(i);
+                yieldChunk();
+            }
+            return;
+        }
+
+        std::atomic<size_t> next = 0;
+        auto worker = [&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                fn(i);
+                yieldChunk();
+            }
+        };
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads; i++) {
+            pool.emplace_back([&]() {
+                if (schedulingSet) {
+                    applyScheduling();
+                }
+                worker();
+            });
+        }
+        worker();
+        for (auto& thread : pool) {
+            thread.join();
+        }
+    }
+
+    /*
+     * Scans a module for `pattern`, reporting every match to `callback` in ascending address
+     * order until it asks to stop. At most `limit` matches are looked for. With a single scan
+     * thread the callback is called straight from the kernel and nothing is allocated, with
+     * more threads every chunk buffers up to `limit` matches which are reported once all
+     * chunks are done. A chunk with `limit` matches of its own makes every later chunk
+     * redundant, so those stop early.
+     */
+    template <typename Pattern>
+    size_t scanModule(void* module, const Pattern& pattern, const char* section, size_t limit, Utils::ScanCallback callback, void* context);
+
+    /*
+     * Parses the IDA-style `pattern` into `bytes` and `mask`. Returns the number of bytes in
+     * the pattern, or 0 if it has more than `maxPatternSize`.
+     */
+    size_t pattern_to_byte(const char* pattern, uint8_t* bytes, uint8_t* mask) {
+        auto start = const_cast<char*>(pattern);
+        auto end = const_cast<char*>(pattern) + strlen(pattern);
+
+        size_t size = 0;
+        for (auto current = start; current < end; ++current) {
+            if (size == maxPatternSize) {
+                return 0;
+            }
+            if (*current == '?') {
+                ++current;
+                if (*current == '?')
+                    ++current;
+                bytes[size] = 0x00;
+                mask[size++] = 0x00;
+            }
+            else {
+                bytes[size] = (uint8_t)strtoul(current, &current, 16);
+                mask[size++] = 0xFF;
+            }
+        }
+        return size;
+    }
+
+    pattern_t compilePattern(const char* signature) {
+        pattern_t pattern;
+        pattern.size = pattern_to_byte(signature, pattern.bytes, pattern.mask);
+        pattern.anchor0 = SIZE_MAX;
+        pattern.anchor1 = SIZE_MAX;
+        auto& bytes = pattern.bytes;
+        for (size_t i = 0; i < pattern.size; i++) {
+            if (!pattern.mask[i]) {
+                continue;
+            }
+            if (pattern.anchor0 == SIZE_MAX || Utils::detail::byteRank(bytes[i]) < Utils::detail::byteRank(bytes[pattern.anchor0])) {
+                pattern.anchor1 = pattern.anchor0;
+                pattern.anchor0 = i;
+            }
+            else if (pattern.anchor1 == SIZE_MAX || Utils::detail::byteRank(bytes[i]) < Utils::detail::byteRank(bytes[pattern.anchor1])) {
+                pattern.anchor1 = i;
+            }
+        }
+        if (pattern.anchor1 == SIZE_MAX) {
+            pattern.anchor1 = pattern.anchor0;
+        }
+        return pattern;
+    }
+
+    /*
+     * The kernels below are shared by patterns parsed at runtime, `pattern_t`, and signatures
+     * compiled at build time, `Utils::SignatureView`. These overloads are all that differs.
+     */
+    size_t patternSize(const pattern_t& pattern) {
+        return pattern.size;
+    }
+
+    uint8_t patternByte(const pattern_t& pattern, size_t i) {
+        return pattern.bytes[i];
+    }
+
+    bool patternFixed(const pattern_t& pattern, size_t i) {
+        return pattern.mask[i] != 0;
+    }
+
+    bool patternMatches(const uint8_t* scanBytes, const pattern_t& pattern) {
+        auto s = pattern.size;
+        auto d = pattern.bytes;
+        auto m = pattern.mask;
+        for (size_t j = 0; j < s; ++j) {
+            if ((scanBytes[j] ^ d[j]) & m[j]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t patternSize(const Utils::SignatureView& signature) {
+        return signature.size;
+    }
+
+    uint8_t patternByte(const Utils::SignatureView& signature, size_t i) {
+        return signature.bytes[i];
+    }
+
+    bool patternFixed(const Utils::SignatureView& signature, size_t i) {
+        return signature.mask[i] != 0;
+    }
+
+    bool patternMatches(const uint8_t* scanBytes, const Utils::SignatureView& signature) {
+        return signature.matches(scanBytes, signature);
+    }
+
+    /*
+     * Single pattern kernels. Every match is reported to `callback`, the kernels return `false`
+     * as soon as the callback asks to stop and `true` once all `count` offsets were scanned.
+     */
+    template <typename Pattern>
+    bool scanScalar(const uint8_t* scanBytes, size_t count, const Pattern& pattern, Utils::ScanCallback callback, void* context) {
+        auto a0 = pattern.anchor0;
+        auto b0 = patternByte(pattern, a0);
+        for (size_t i = 0; i < count; ++i) {
+            if (scanBytes[i + a0] == b0 && patternMatches(&scanBytes[i], pattern)) {
+                if (!callback((uint64_t)&scanBytes[i], context)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <typename Pattern>
+    bool scanSse2(const uint8_t* scanBytes, size_t count, const Pattern& pattern, Utils::ScanCallback callback, void* context) {
+        auto a0 = pattern.anchor0;
+        auto a1 = pattern.anchor1;
+        const __m128i b0 = _mm_set1_epi8((char)patternByte(pattern, a0));
+        const __m128i b1 = _mm_set1_epi8((char)patternByte(pattern, a1));
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i c0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&scanBytes[i + a0]), b0);
+            __m128i c1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)&scanBytes[i + a1]), b1);
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(c0, c1));
+            while (mask) {
+                auto j = i + std::countr_zero(mask);
+                mask &= mask - 1;
+                if (patternMatches(&scanBytes[j], pattern)) {
+                    if (!callback((uint64_t)&scanBytes[j], context)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return scanScalar(&scanBytes[i], count - i, pattern, callback, context);
+    }
+
+    template <typename Pattern>
+    TARGET_AVX2 bool scanAvx2(const uint8_t* scanBytes, size_t count, const Pattern& pattern, Utils::ScanCallback callback, void* context) {
+        auto a0 = pattern.anchor0;
+        auto a1 = pattern.anchor1;
+        const __m256i b0 = _mm256_set1_epi8((char)patternByte(pattern, a0));
+        const __m256i b1 = _mm256_set1_epi8((char)patternByte(pattern, a1));
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i c0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&scanBytes[i + a0]), b0);
+            __m256i c1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)&scanBytes[i + a1]), b1);
+            uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(c0, c1));
+            while (mask) {
+                auto j = i + std::countr_zero(mask);
+                mask &= mask - 1;
+                if (patternMatches(&scanBytes[j], pattern)) {
+                    if (!callback((uint64_t)&scanBytes[j], context)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return scanScalar(&scanBytes[i], count - i, pattern, callback, context);
+    }
+
+    bool detectAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    bool cpuSupportsAvx2() {
+        static const bool avx2 = detectAvx2();
+        return avx2;
+    }
+
+#ifdef ENABLE_BENCH_KERNELS
+    typedef struct run_t {
+        size_t offset;
+        size_t size;
+    } run_t;
+
+    /*
+     * Longest stretch of consecutive non-wildcard bytes, the first one wins a tie.
+     */
+    template <typename Pattern>
+    run_t longestRun(const Pattern& pattern) {
+        run_t best = { 0, 0 };
+        size_t start = 0;
+        auto s = patternSize(pattern);
+        for (size_t i = 0; i <= s; ++i) {
+            if (i < s && patternFixed(pattern, i)) {
+                continue;
+            }
+            if (i - start > best.size) {
+                best = { start, i - start };
+            }
+            start = i + 1;
+        }
+        return best;
+    }
+
+    /*
+     * Horspool search on the longest fixed run of the pattern, every hit of the run is then
+     * verified against the whole pattern. The skip table is keyed on the byte under the last
+     * byte of the run and moves the window past every position where the run cannot start,
+     * so a long run skips up to its length per mismatch instead of checking every offset.
+     */
+    template <typename Pattern>
+    bool scanHorspool(const uint8_t* scanBytes, size_t count, const Pattern& pattern, Utils::ScanCallback callback, void* context) {
+        auto run = longestRun(pattern);
+        auto last = run.offset + run.size - 1;
+        auto lastByte = patternByte(pattern, last);
+
+        size_t skip[256];
+        for (auto& shift : skip) {
+            shift = run.size;
+        }
+        for (size_t j = 0; j + 1 < run.size; ++j) {
+            skip[patternByte(pattern, run.offset + j)] = run.size - 1 - j;
+        }
+
+        for (size_t i = 0; i < count; ) {
+            auto c = scanBytes[i + last];
+            if (c == lastByte && patternMatches(&scanBytes[i], pattern)) {
+                if (!callback((uint64_t)&scanBytes[i], context)) {
+                    return false;
+                }
+            }
+            i += skip[c];
+        }
+        return true;
+    }
+#endif
+
+    /*
+     * Kernel forced through `Utils::setScanKernel`, AVX2 is only used if the CPU supports it.
+     */
+    Utils::ScanKernel scanKernel = Utils::ScanKernel::Auto;
+
+    Utils::ScanKernel activeKernel() {
+        switch (scanKernel) {
+        case Utils::ScanKernel::Scalar:
+        case Utils::ScanKernel::Sse2:
+            return scanKernel;
+        default:
+            return cpuSupportsAvx2() ? Utils::ScanKernel::Avx2 : Utils::ScanKernel::Sse2;
+        }
+    }
+
+    template <typename Pattern>
+    scan_kernel_t<Pattern> selectKernel() {
+#ifdef ENABLE_BENCH_KERNELS
+        if (scanKernel == Utils::ScanKernel::Horspool) {
+            return scanHorspool<Pattern>;
+        }
+#endif
+        switch (activeKernel()) {
+        case Utils::ScanKernel::Scalar:
+            return scanScalar<Pattern>;
+        case Utils::ScanKernel::Avx2:
+            return scanAvx2<Pattern>;
+        default:
+            return scanSse2<Pattern>;
+        }
+    }
+
+    /*
+     * Verifies every pattern anchored on the byte at offset `i`. The pattern start is derived
+     * from the anchor offset, candidates that would fall outside of the scan range are ignored.
+     */
+    template <typename Pattern>
+    void checkAnchors(const uint8_t* scanBytes, size_t size, size_t i, const std::vector<anchor_t>& anchors,
+        const std::vector<Pattern>& patterns, batch_hits_t* hits) {
+        for (auto& anchor : anchors) {
+            if (i < anchor.offset) {
+                continue;
+            }
+            auto start = i - anchor.offset;
+            auto& pattern = patterns[anchor.index];
+            if (start + patternSize(pattern) > size) {
+                continue;
+            }
+            auto& address = hits->address[anchor.index];
+            if (address.size() < hits->maxMatches && patternMatches(&scanBytes[start], pattern)) {
+                address.push_back((uint64_t)&scanBytes[start]);
+                if (address.size() == hits->maxMatches) {
+                    hits->pending--;
+                }
+            }
+        }
+    }
+
+    /*
+     * Multi-pattern scan. Every offset whose byte is one of the anchor bytes in `needles` is
+     * found with vector compares, the patterns anchored on that byte are then verified. With
+     * more distinct anchor bytes than fit in the needle set every offset is looked up instead.
+     * The kernels return early once every pattern has reached its maximum number of matches.
+     */
+    constexpr size_t maxNeedles = 8;
+
+    template <typename Pattern>
+    void batchScalar(const uint8_t* scanBytes, size_t begin, size_t end, size_t size, const std::vector<anchor_t>* anchors,
+        const std::vector<Pattern>& patterns, batch_hits_t* hits) {
+        for (size_t i = begin; i < end && hits->pending; ++i) {
+            auto& bucket = anchors[scanBytes[i]];
+            if (!bucket.empty()) {
+                checkAnchors(scanBytes, size, i, bucket, patterns, hits);
+            }
+        }
+    }
+
+    template <typename Pattern>
+    void batchSse2(const uint8_t* scanBytes, size_t begin, size_t end, size_t size, const std::vector<uint8_t>& needles, const std::vector<anchor_t>* anchors,
+        const std::vector<Pattern>& patterns, batch_hits_t* hits) {
+        __m128i n[maxNeedles];
+        for (size_t k = 0; k < needles.size(); k++) {
+            n[k] = _mm_set1_epi8((char)needles[k]);
+        }
+        size_t i = begin;
+        for (; i + 16 <= end && hits->pending; i += 16) {
+            __m128i block = _mm_loadu_si128((const __m128i*)&scanBytes[i]);
+            __m128i found = _mm_setzero_si128();
+            for (size_t k = 0; k < needles.size(); k++) {
+                found = _mm_or_si128(found, _mm_cmpeq_epi8(block, n[k]));
+            }
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(found);
+            while (mask) {
+                auto j = i + std::countr_zero(mask);
+                mask &= mask - 1;
+                checkAnchors(scanBytes, size, j, anchors[scanBytes[j]], patterns, hits);
+            }
+        }
+        batchScalar(scanBytes, i, end, size, anchors, patterns, hits);
+    }
+
+    template <typename Pattern>
+    TARGET_AVX2 void batchAvx2(const uint8_t* scanBytes, size_t begin, size_t end, size_t size, const std::vector<uint8_t>& needles, const std::vector<anchor_t>* anchors,
+        const std::vector<Pattern>& patterns, batch_hits_t* hits) {
+        __m256i n[maxNeedles];
+        for (size_t k = 0; k < needles.size(); k++) {
+            n[k] = _mm256_set1_epi8((char)needles[k]);
+        }
+        size_t i = begin;
+        for (; i + 32 <= end && hits->pending; i += 32) {
+            __m256i block = _mm256_loadu_si256((const __m256i*)&scanBytes[i]);
+            __m256i found = _mm256_setzero_si256();
+            for (size_t k = 0; k < needles.size(); k++) {
+                found = _mm256_or_si256(found, _mm256_cmpeq_epi8(block, n[k]));
+            }
+            uint32_t mask = (uint32_t)_mm256_movemask_epi8(found);
+            while (mask) {
+                auto j = i + std::countr_zero(mask);
+                mask &= mask - 1;
+                checkAnchors(scanBytes, size, j, anchors[scanBytes[j]], patterns, hits);
+            }
+        }
+        batchScalar(scanBytes, i, end, size, anchors, patterns, hits);
+    }
+
+    template <typename Pattern>
+    size_t scanModule(void* module, const Pattern& pattern, const char* section, size_t limit, Utils::ScanCallback callback, void* context) {
+        struct counter_t {
+            Utils::ScanCallback callback;
+            void* context;
+            size_t found;
+        } counter = { callback, context, 0 };
+
+        auto s = patternSize(pattern);
+        if (pattern.anchor0 == SIZE_MAX || limit == 0) {
+            return 0;
+        }
+
+        auto ranges = getScanRanges(module, section);
+        if (getThreadCount() == 1) {
+            for (size_t i = 0; i < ranges.count; i++) {
+                auto& range = ranges.range[i];
+                if (s > range.size) {
+                    continue;
+                }
+                bool more = selectKernel<Pattern>()(range.base, range.size - s + 1, pattern, [](uint64_t hit, void* context) {
+                    auto counter = (counter_t*)context;
+                    counter->found++;
+                    return counter->callback(hit, counter->context);
+                }, &counter);
+                if (!more) {
+                    break;
+                }
+                yieldChunk();
+            }
+            return counter.found;
+        }
+
+        auto chunks = splitRanges(ranges);
+        std::vector<std::vector<uint64_t>> hits(chunks.size());
+        std::atomic<size_t> cutoff = SIZE_MAX;
+        parallelFor(chunks.size(), [&](size_t i) {
+            auto& chunk = chunks[i];
+            if (s > chunk.range.size || i > cutoff) {
+                return;
+            }
+            struct chunk_hits_t {
+                std::vector<uint64_t>* address;
+                size_t limit;
+            } chunkHits = { &hits[i], limit };
+            // The last offsets of a chunk read up to `s - 1` bytes into the next chunk
+            size_t end = std::min(chunk.end, chunk.range.size - s + 1);
+            if (chunk.begin < end) {
+                selectKernel<Pattern>()(chunk.range.base + chunk.begin, end - chunk.begin, pattern, [](uint64_t hit, void* context) {
+                    auto chunkHits = (chunk_hits_t*)context;
+                    chunkHits->address->push_back(hit);
+                    return chunkHits->address->size() < chunkHits->limit;
+                }, &chunkHits);
+            }
+            if (hits[i].size() >= limit) {
+                for (size_t c = cutoff; i < c && !cutoff.compare_exchange_weak(c, i); ) {}
+            }
+        });
+        for (auto& hit : hits) {
+            for (auto address : hit) {
+                counter.found++;
+                if (!callback(address, context)) {
+                    return counter.found;
+                }
+            }
+        }
+        return counter.found;
+    }
+
+    /*
+     * Scans a module for the first `count` matches of `pattern`, writing them into `address`.
+     */
+    template <typename Pattern>
+    size_t scanModuleInto(void* module, const Pattern& pattern, uint64_t* address, size_t count, const char* section) {
+        struct buffer_t {
+            uint64_t* address;
+            size_t count;
+            size_t found;
+        } buffer = { address, count, 0 };
+
+        if (count == 0) {
+            return 0;
+        }
+        return scanModule(module, pattern, section, count, [](uint64_t hit, void* context) {
+            auto buffer = (buffer_t*)context;
+            buffer->address[buffer->found++] = hit;
+            return buffer->found < buffer->count;
+        }, &buffer);
+    }
+
+    /*
+     * Multi-pattern scan over a module, see the batch `Utils::patternScan` for details.
+     */
+    template <typename Pattern>
+    void batchScan(void* module, const std::vector<Pattern>& patterns, std::vector<std::vector<uint64_t>>* address, size_t maxMatches, const char* section) {
+        if (address->size() < patterns.size()) {
+            address->resize(patterns.size());
+        }
+
+        // Key every signature on its rarest non-wildcard byte
+        std::vector<anchor_t> anchors[256];
+        std::vector<uint8_t> needles;
+        for (size_t i = 0; i < patterns.size(); i++) {
+            auto& pattern = patterns[i];
+            if (pattern.anchor0 == SIZE_MAX) {
+                continue;
+            }
+            auto needle = patternByte(pattern, pattern.anchor0);
+            if (anchors[needle].empty()) {
+                needles.push_back(needle);
+            }
+            anchors[needle].push_back({ i, pattern.anchor0 });
+        }
+
+        if (needles.empty() || maxMatches == 0) {
+            return;
+        }
+        size_t pending = 0;
+        for (auto& needle : needles) {
+            pending += anchors[needle].size();
+        }
+
+        auto chunks = splitRanges(getScanRanges(module, section));
+        std::vector<batch_hits_t> hits(chunks.size());
+        std::atomic<size_t> cutoff = SIZE_MAX;
+        auto kernel = activeKernel();
+        parallelFor(chunks.size(), [&](size_t i) {
+            auto& chunk = chunks[i];
+            auto& base = chunk.range.base;
+            auto& size = chunk.range.size;
+            hits[i] = { std::vector<std::vector<uint64_t>>(patterns.size()), maxMatches, pending };
+            if (i > cutoff) {
+                return;
+            }
+            if (needles.size() > maxNeedles || kernel == Utils::ScanKernel::Scalar) {
+                batchScalar(base, chunk.begin, chunk.end, size, anchors, patterns, &hits[i]);
+            }
+            else if (kernel == Utils::ScanKernel::Avx2) {
+                batchAvx2(base, chunk.begin, chunk.end, size, needles, anchors, patterns, &hits[i]);
+            }
+            else {
+                batchSse2(base, chunk.begin, chunk.end, size, needles, anchors, patterns, &hits[i]);
+            }
+            // Every signature has all its matches in this chunk, later chunks are redundant
+            if (hits[i].pending == 0) {
+                for (size_t c = cutoff; i < c && !cutoff.compare_exchange_weak(c, i); ) {}
+            }
+        });
+        for (size_t i = 0; i < patterns.size(); i++) {
+            for (auto& hit : hits) {
+                auto& from = hit.address[i];
+                auto& to = (*address)[i];
+                auto n = std::min(from.size(), maxMatches - std::min(maxMatches, to.size()));
+                to.insert(to.end(), from.begin(), from.begin() + n);
+            }
+        }
+    }
+}
+
 namespace Utils
 {
     std::string getCompilerInfo() {
@@ -84,55 +971,219 @@ namespace Utils
             return bytes;
         };
 
-        DWORD oldProtect;
-        auto patternBytes = pattern_to_byte(pattern);
-        VirtualProtect((LPVOID)address, patternBytes.size(), PAGE_EXECUTE_READWRITE, &oldProtect);
-        memcpy((LPVOID)address, patternBytes.data(), patternBytes.size());
-        VirtualProtect((LPVOID)address, patternBytes.size(), oldProtect, &oldProtect);
+        patch(address, pattern_to_byte(pattern));
     }
 
-    void patternScan(void* module, const char* signature, std::vector<uint64_t>* address)
+    void patch(uintptr_t address, std::span<const uint8_t> bytes)
     {
-        static auto pattern_to_byte = [](const char* pattern) {
-            auto bytes = std::vector<int>{};
-            auto start = const_cast<char*>(pattern);
-            auto end = const_cast<char*>(pattern) + strlen(pattern);
+        DWORD oldProtect;
+        VirtualProtect((LPVOID)address, bytes.size(), PAGE_EXECUTE_READWRITE, &oldProtect);
+        memcpy((LPVOID)address, bytes.data(), bytes.size());
+        VirtualProtect((LPVOID)address, bytes.size(), oldProtect, &oldProtect);
+    }
 
-            for (auto current = start; current < end; ++current) {
-                if (*current == '?') {
-                    ++current;
-                    if (*current == '?')
-                        ++current;
-                    bytes.push_back(-1);
+    void PatchBatch::add(uintptr_t address, std::span<const uint8_t> bytes) {
+        entries.push_back({ address, data.size(), bytes.size() });
+        data.insert(data.end(), bytes.begin(), bytes.end());
+    }
+
+    size_t PatchBatch::commit() {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        uintptr_t pageMask = (uintptr_t)systemInfo.dwPageSize - 1;
+
+        // Stable so that overlapping patches are still applied in the order they were added
+        std::stable_sort(entries.begin(), entries.end(), [](const entry_t& a, const entry_t& b) {
+            return a.address < b.address;
+        });
+
+        size_t protects = 0;
+        size_t first = 0;
+        while (first < entries.size()) {
+            // Grow the range of pages for as long as the next patch starts on or right after it
+            uintptr_t begin = entries[first].address & ~pageMask;
+            uintptr_t end = (entries[first].address + entries[first].size + pageMask) & ~pageMask;
+            size_t last = first + 1;
+            while (last < entries.size() && entries[last].address <= end) {
+                end = std::max(end, (entries[last].address + entries[last].size + pageMask) & ~pageMask);
+                last++;
+            }
+
+            // Split the range where the protection of the pages changes
+            for (uintptr_t current = begin; current < end;) {
+                MEMORY_BASIC_INFORMATION memoryInfo;
+                uintptr_t regionEnd = end;
+                if (VirtualQuery((LPCVOID)current, &memoryInfo, sizeof(memoryInfo))) {
+                    regionEnd = std::min(end, (uintptr_t)memoryInfo.BaseAddress + (uintptr_t)memoryInfo.RegionSize);
                 }
-                else {
-                    bytes.push_back(strtoul(current, &current, 16));
+
+                DWORD oldProtect;
+                VirtualProtect((LPVOID)current, regionEnd - current, PAGE_EXECUTE_READWRITE, &oldProtect);
+                for (size_t i = first; i < last; i++) {
+                    uintptr_t from = std::max(current, entries[i].address);
+                    uintptr_t to = std::min(regionEnd, entries[i].address + entries[i].size);
+                    if (from < to) {
+                        memcpy((LPVOID)from, data.data() + entries[i].offset + (from - entries[i].address), to - from);
+                    }
                 }
+                VirtualProtect((LPVOID)current, regionEnd - current, oldProtect, &oldProtect);
+                protects++;
+                current = regionEnd;
             }
-            return bytes;
-        };
+            first = last;
+        }
 
-        auto dosHeader = (PIMAGE_DOS_HEADER)module;
-        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        entries.clear();
+        data.clear();
+        return protects;
+    }
 
-        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
-        auto patternBytes = pattern_to_byte(signature);
-        auto scanBytes = reinterpret_cast<std::uint8_t*>(module);
+    bool waitForWrite(uintptr_t address, size_t size, WriteCheck ready, DWORD timeout, DWORD settle) {
+        ULONGLONG deadline = GetTickCount64() + timeout;
+        while (!ready(address)) {
+            ULONGLONG now = GetTickCount64();
+            if (now >= deadline) {
+                return false;
+            }
+            Sleep(std::min<DWORD>(writePollInterval, (DWORD)(deadline - now)));
+        }
 
-        auto s = patternBytes.size();
-        auto d = patternBytes.data();
+        // Keep polling until the range has not changed for `settle` milliseconds, or the deadline
+        std::vector<uint8_t> last((const uint8_t*)address, (const uint8_t*)address + size);
+        ULONGLONG settled = GetTickCount64() + settle;
+        for (ULONGLONG now = GetTickCount64(); now < settled && now < deadline; now = GetTickCount64()) {
+            Sleep(std::min<DWORD>(writePollInterval, (DWORD)(std::min(settled, deadline) - now)));
+            if (memcmp(last.data(), (const void*)address, size) != 0) {
+                memcpy(last.data(), (const void*)address, size);
+                settled = GetTickCount64() + settle;
+            }
+        }
+        return true;
+    }
 
-        for (auto i = 0ul; i < sizeOfImage - s; ++i) {
-            bool found = true;
-            for (auto j = 0ul; j < s; ++j) {
-                if (scanBytes[i + j] != d[j] && d[j] != -1) {
-                    found = false;
-                    break;
+    void setScanKernel(ScanKernel kernel) {
+        scanKernel = kernel;
+    }
+
+    void setScanThreads(unsigned threads) {
+        scanThreads = threads;
+    }
+
+    bool setScheduling(const SchedulingPolicy& policy) {
+        scheduling = policy;
+        schedulingSet = true;
+        cpuSets = policy.efficiencyCores ? efficiencyCpuSets() : std::vector<ULONG>();
+        bool applied = applyScheduling();
+        return applied && (!policy.efficiencyCores || !cpuSets.empty());
+    }
+
+    void patternScan(void* module, const char* signature, std::vector<uint64_t>* address, const char* section)
+    {
+        auto pattern = compilePattern(signature);
+        scanModule(module, pattern, section, SIZE_MAX, [](uint64_t hit, void* context) {
+            ((std::vector<uint64_t>*)context)->push_back(hit);
+            return true;
+        }, address);
+    }
+
+    size_t patternScan(void* module, const char* signature, ScanCallback callback, void* context, const char* section)
+    {
+        auto pattern = compilePattern(signature);
+        return scanModule(module, pattern, section, SIZE_MAX, callback, context);
+    }
+
+    size_t patternScan(void* module, const char* signature, uint64_t* address, size_t count, const char* section)
+    {
+        auto pattern = compilePattern(signature);
+        return scanModuleInto(module, pattern, address, count, section);
+    }
+
+    std::optional<uintptr_t> patternScanFirst(void* module, const char* signature, const char* section)
+    {
+        uint64_t address;
+        if (patternScan(module, signature, &address, 1, section) == 0) {
+            return std::nullopt;
+        }
+        return (uintptr_t)address;
+    }
+
+    size_t pairScan(void* module, uint32_t first, uint32_t second, uint64_t* address, size_t count)
+    {
+        auto ranges = getScanRanges(module, nullptr, IMAGE_SCN_MEM_WRITE);
+        const __m128i a = _mm_set1_epi32((int)first);
+        const __m128i b = _mm_set1_epi32((int)second);
+        size_t found = 0;
+        for (size_t r = 0; r < ranges.count && found < count; r++) {
+            const uint8_t* scanBytes = ranges.range[r].base;
+            size_t size = ranges.range[r].size;
+            size_t i = 0;
+            // Four offsets at a time, the value at every offset compared with `first` and the
+            // value 4 bytes after it with `second`
+            for (; i + 20 <= size; i += 16) {
+                __m128i c0 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&scanBytes[i]), a);
+                __m128i c1 = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)&scanBytes[i + 4]), b);
+                uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(c0, c1)));
+                while (mask) {
+                    address[found++] = (uint64_t)&scanBytes[i + 4 * std::countr_zero(mask)];
+                    if (found == count) {
+                        return found;
+                    }
+                    mask &= mask - 1;
                 }
             }
-            if (found) {
-                address->push_back((uint64_t)&scanBytes[i]);
+            for (; i + 8 <= size; i += 4) {
+                uint32_t pair[2];
+                memcpy(pair, &scanBytes[i], sizeof(pair));
+                if (pair[0] == first && pair[1] == second) {
+                    address[found++] = (uint64_t)&scanBytes[i];
+                    if (found == count) {
+                        return found;
+                    }
+                }
             }
         }
+        return found;
+    }
+
+    void patternScan(void* module, const std::vector<const char*>& signatures, std::vector<std::vector<uint64_t>>* address, size_t maxMatches, const char* section)
+    {
+        std::vector<pattern_t> patterns;
+        patterns.reserve(signatures.size());
+        for (auto signature : signatures) {
+            patterns.push_back(compilePattern(signature));
+        }
+        batchScan(module, patterns, address, maxMatches, section);
+    }
+
+    void patternScan(void* module, const std::vector<SignatureView>& signatures, std::vector<std::vector<uint64_t>>* address, size_t maxMatches, const char* section)
+    {
+        batchScan(module, signatures, address, maxMatches, section);
+    }
+
+    void patternScan(void* module, const SignatureView& signature, std::vector<uint64_t>* address, const char* section)
+    {
+        scanModule(module, signature, section, SIZE_MAX, [](uint64_t hit, void* context) {
+            ((std::vector<uint64_t>*)context)->push_back(hit);
+            return true;
+        }, address);
+    }
+
+    size_t patternScan(void* module, const SignatureView& signature, ScanCallback callback, void* context, const char* section)
+    {
+        return scanModule(module, signature, section, SIZE_MAX, callback, context);
+    }
+
+    size_t patternScan(void* module, const SignatureView& signature, uint64_t* address, size_t count, const char* section)
+    {
+        return scanModuleInto(module, signature, address, count, section);
+    }
+
+    std::optional<uintptr_t> patternScanFirst(void* module, const SignatureView& signature, const char* section)
+    {
+        uint64_t address;
+        if (scanModuleInto(module, signature, &address, 1, section) == 0) {
+            return std::nullopt;
+        }
+        return (uintptr_t)address;
     }
 }